@@ -10,7 +10,9 @@
 # FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
 # WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
-SHARED_COPTS = []
+# the heap allocations of Eigen can be forbidden at runtime, which the tests use to check that the steps do not
+# allocate, it has to be defined for all the targets alike
+SHARED_COPTS = ["-DEIGEN_RUNTIME_NO_MALLOC"]
 
 def get_from_dict(dct, key, val=[]):
     if key in dct:
@@ -36,6 +38,7 @@ def pooya_cc_library(name, srcs, **kwargs):
             "-lboost_iostreams",
             "-lboost_system",
             "-lboost_filesystem",
+            "-lpthread",
             ],
         deps = deps,
         **kwargs
@@ -68,12 +71,13 @@ def pooya_cc_binary(name, src, **kwargs):
 
 def pooya_cc_test(name, src, **kwargs):
     deps = get_from_dict(kwargs, "deps")
+    copts = get_from_dict(kwargs, "copts")
 
     native.cc_test(
         name = name,
         size = "small",
         srcs = [src],
-        copts = SHARED_COPTS,
+        copts = SHARED_COPTS + copts,
         deps = [
             "@com_google_googletest//:gtest_main",
         ] + deps,
@@ -0,0 +1,117 @@
+/*
+Copyright 2024 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <iostream>
+
+#include "src/block/extra/add.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/helper/trace.hpp"
+#include "src/misc/gp-ios.hpp"
+#include "src/solver/fast_simulator.hpp"
+#include "src/solver/history.hpp"
+#include "src/solver/rk4.hpp"
+
+// An ensemble of mass-spring-damper systems simulated in lock step. Every signal is an array with one element per
+// member of the ensemble, so the model is traversed once per step for all the members.
+class MassSpringDamperEnsemble : public pooya::Submodel
+{
+protected:
+    pooya::IntegratorA _integ_xd;
+    pooya::IntegratorA _integ_x;
+    pooya::GainAA _gain_k;
+    pooya::GainAA _gain_c;
+    pooya::AddA _add;
+
+public:
+    pooya::ArraySignal _s_x;
+    pooya::ArraySignal _s_xd;
+    pooya::ArraySignal _s_xdd;
+
+    MassSpringDamperEnsemble(const pooya::Array& m, const pooya::Array& k, const pooya::Array& c,
+                             const pooya::Array& x0, const pooya::Array& xd0)
+        : pooya::Submodel(nullptr, "msd_ensemble"), _integ_xd(xd0, this, "xd"), _integ_x(x0, this, "x"),
+          _gain_k(-k / m, this, "-k/m"), _gain_c(-c / m, this, "-c/m"), _add(pooya::Array::Zero(m.size()), this),
+          _s_x(m.size(), "x"), _s_xd(m.size(), "xd"), _s_xdd(m.size(), "xdd")
+    {
+        pooya_trace0;
+
+        pooya::ArraySignal s10(m.size());
+        pooya::ArraySignal s20(m.size());
+
+        // setup the submodel
+        _integ_xd.connect({_s_xdd}, {_s_xd});
+        _integ_x.connect({_s_xd}, {_s_x});
+        _gain_k.connect({_s_x}, {s10});
+        _gain_c.connect({_s_xd}, {s20});
+        _add.connect({s10, s20}, {_s_xdd});
+    }
+};
+
+int main()
+{
+    pooya_trace0;
+
+    using milli = std::chrono::milliseconds;
+    auto start  = std::chrono::high_resolution_clock::now();
+
+    // the members differ in damping and initial position
+    constexpr int N       = 5;
+    const pooya::Array m  = pooya::Array::Constant(N, 1.0);
+    const pooya::Array k  = pooya::Array::Constant(N, 1.0);
+    const pooya::Array c  = pooya::Array::LinSpaced(N, 0.1, 0.9);
+    const pooya::Array x0 = pooya::Array::LinSpaced(N, 0.5, 0.1);
+
+    // create pooya blocks
+    MassSpringDamperEnsemble model(m, k, c, x0, pooya::Array::Zero(N));
+
+    pooya::Rk4 stepper;
+    pooya::FastSimulator sim(model, nullptr, &stepper);
+
+    pooya::History history;
+    history.track(model._s_x);
+
+    uint ind{0};
+    for (double t = 0; t <= 20; t += 0.01)
+    {
+        sim.run(t);
+        history.update(ind++, t);
+    }
+
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::cout << "It took " << std::chrono::duration_cast<milli>(finish - start).count() << " milliseconds\n";
+
+    history.shrink_to_fit();
+
+    const auto& x = history[model._s_x];
+
+    Gnuplot gp;
+    gp << "set xrange [0:" << history.nrows() - 1 << "]\n";
+    gp << "set yrange [-0.5:0.5]\n";
+    gp << "plot";
+    for (int n = 0; n < N; n++)
+    {
+        gp << (n == 0 ? "" : ",") << gp.file1d(pooya::Array(x.col(n))) << "with lines title 'x" << n << "'";
+    }
+    gp << "\n";
+
+    pooya_debug_verify0(pooya::helper::pooya_trace_info.size() == 1);
+
+    return 0;
+}
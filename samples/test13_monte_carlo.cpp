@@ -0,0 +1,148 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "src/block/extra/add.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/helper/trace.hpp"
+#include "src/misc/gp-ios.hpp"
+#include "src/solver/ensemble_runner.hpp"
+#include "src/solver/fast_simulator.hpp"
+#include "src/solver/rk4.hpp"
+
+// a gain that can be changed between the samples
+class ParameterGain : public pooya::Gain
+{
+public:
+    ParameterGain(double k, pooya::Submodel* parent, std::string_view name) : pooya::Gain(k, parent, name) {}
+
+    void set_gain(double k) { _k = k; }
+};
+
+// an integrator whose initial value can be changed between the samples
+class ParameterIntegrator : public pooya::Integrator
+{
+public:
+    ParameterIntegrator(double ic, pooya::Submodel* parent, std::string_view name) : pooya::Integrator(ic, parent, name)
+    {
+    }
+
+    void set_value(double value) { _value = value; }
+};
+
+class MassSpringDamper : public pooya::Submodel
+{
+protected:
+    double _m;
+
+    pooya::Integrator _integ_xd;
+    ParameterIntegrator _integ_x;
+    pooya::Gain _gain_k;
+    ParameterGain _gain_c;
+    pooya::Add _add{0.0, this};
+
+public:
+    pooya::ScalarSignal _s_x{"x"};
+    pooya::ScalarSignal _s_xd{"xd"};
+    pooya::ScalarSignal _s_xdd{"xdd"};
+
+    MassSpringDamper(double m, double k, double c, double x0, double xd0)
+        : pooya::Submodel(nullptr, "msd"), _m(m), _integ_xd(xd0, this, "xd"), _integ_x(x0, this, "x"),
+          _gain_k(-k / m, this, "-k/m"), _gain_c(-c / m, this, "-c/m")
+    {
+        pooya_trace0;
+
+        pooya::ScalarSignal s10;
+        pooya::ScalarSignal s20;
+
+        // setup the submodel
+        _integ_xd.connect({_s_xdd}, {_s_xd});
+        _integ_x.connect({_s_xd}, {_s_x});
+        _gain_k.connect({_s_x}, {s10});
+        _gain_c.connect({_s_xd}, {s20});
+        _add.connect({s10, s20}, {_s_xdd});
+    }
+
+    void set_damping(double c) { _gain_c.set_gain(-c / _m); }
+    void set_initial_position(double x0) { _integ_x.set_value(x0); }
+};
+
+// the model with its own stepper and simulator, reused for the samples of a thread
+class Instance : public pooya::EnsembleRunner::Instance
+{
+public:
+    MassSpringDamper _model{1.0, 1.0, 0.1, 0.5, 0.0};
+    pooya::Rk4 _stepper;
+    pooya::FastSimulator _sim{_model, nullptr, &_stepper};
+
+    pooya::SimulatorBase& simulator() override { return _sim; }
+
+    // params: damping, initial position
+    void reset(const pooya::Array& params) override
+    {
+        _model.set_damping(params[0]);
+        _model.set_initial_position(params[1]);
+    }
+};
+
+int main()
+{
+    pooya_trace0;
+
+    using milli = std::chrono::milliseconds;
+    auto start  = std::chrono::high_resolution_clock::now();
+
+    pooya::EnsembleRunner runner(
+        []() { return std::make_unique<Instance>(); },
+        [](std::size_t sample) -> pooya::Array
+        {
+            // seeding with the sample number makes the study reproducible
+            std::mt19937 gen(static_cast<std::mt19937::result_type>(sample));
+            std::uniform_real_distribution<double> damping(0.05, 0.5);
+            std::normal_distribution<double> position(0.5, 0.1);
+            return pooya::Array2{damping(gen), position(gen)};
+        },
+        [](pooya::EnsembleRunner::Instance& instance, pooya::History& history)
+        { history.track(static_cast<Instance&>(instance)._model._s_x); });
+
+    runner.run(1000, 0, 20, 0.01);
+
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::cout << "It took " << std::chrono::duration_cast<milli>(finish - start).count() << " milliseconds\n";
+
+    const auto& x            = runner["x"];
+    const pooya::Array mean  = x.rowwise().mean();
+    const pooya::Array stdev = ((x.colwise() - mean.matrix()).array().square().rowwise().sum() /
+                                static_cast<double>(runner.num_samples() - 1))
+                                   .sqrt();
+
+    Gnuplot gp;
+    gp << "set xrange [0:" << runner.time().size() - 1 << "]\n";
+    gp << "set yrange [-0.8:0.8]\n";
+    gp << "plot" << gp.file1d(mean) << "with lines title 'mean(x)'," << gp.file1d(pooya::Array(mean + stdev))
+       << "with lines title 'mean(x) + std(x)'," << gp.file1d(pooya::Array(mean - stdev))
+       << "with lines title 'mean(x) - std(x)'\n";
+
+    pooya_debug_verify0(pooya::helper::pooya_trace_info.size() == 1);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_BLOCK_ARCHIVE_HPP__
+#define __POOYA_BLOCK_ARCHIVE_HPP__
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "src/helper/util.hpp"
+#include "src/helper/verify.hpp"
+#include "src/signal/array.hpp"
+
+namespace pooya
+{
+
+// A compact binary image of the state of a simulation, see SimulatorBase::save_checkpoint(). The same serialize()
+// function writes the state to an archive that is saving and reads it back from one that is loading, so the two
+// directions cannot get out of sync. The values are stored in the native byte order, an image is meant to be loaded
+// into the same model on the same platform.
+class Archive
+{
+public:
+    using Blob = std::vector<char>;
+
+    Archive() = default; // saving
+    explicit Archive(const Blob& blob) : _loading(true), _blob(blob) {}
+
+    bool loading() const { return _loading; }
+    const Blob& blob() const { return _blob; }
+    bool at_end() const { return _pos == _blob.size(); }
+
+    template<typename T>
+    std::enable_if_t<std::is_arithmetic_v<T>> operator()(T& value)
+    {
+        bytes(&value, sizeof(T));
+    }
+
+    template<int N>
+    void operator()(ArrayN<N>& value)
+    {
+        std::size_t size = value.size();
+        (*this)(size);
+        if (_loading)
+        {
+            // a fixed-size array cannot be resized, e.g. to the size of the array of another model
+            pooya_verify((N == Eigen::Dynamic) || (size == static_cast<std::size_t>(N)),
+                         "checkpoint: the size of an array does not match!");
+            value.resize(size);
+        }
+        bytes(value.data(), size * sizeof(double));
+    }
+
+    template<typename T>
+    void operator()(std::vector<T>& values)
+    {
+        std::size_t size = values.size();
+        (*this)(size);
+        if (_loading)
+        {
+            values.resize(size);
+        }
+        for (auto& value : values)
+        {
+            (*this)(value);
+        }
+    }
+
+protected:
+    bool _loading{false};
+    Blob _blob;
+    std::size_t _pos{0}; // the read position when loading
+
+    void bytes(void* data, std::size_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+
+        if (_loading)
+        {
+            pooya_verify(_pos + size <= _blob.size(), "checkpoint: unexpected end of the data!");
+            std::memcpy(data, _blob.data() + _pos, size);
+            _pos += size;
+        }
+        else
+        {
+            const auto* p = static_cast<const char*>(data);
+            _blob.insert(_blob.end(), p, p + size);
+        }
+    }
+};
+
+} // namespace pooya
+
+#endif // __POOYA_BLOCK_ARCHIVE_HPP__
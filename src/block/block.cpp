@@ -117,6 +117,17 @@ Block::SignalLinkPair* Block::find_linked_signal(SignalImpl& impl)
     return it == _linked_signals.end() ? nullptr : &(*it);
 }
 
+void Block::set_direct_feedthrough(const Signal& sig, bool direct_feedthrough)
+{
+    pooya_trace("block: " + full_name().str());
+
+    auto* pair = find_linked_signal(sig.impl());
+    pooya_verify(pair, full_name().str() + ": " + sig->name().str() + " is not linked to the block!");
+
+    pair->second = direct_feedthrough ? (pair->second | SignalLinkType::Required)
+                                      : (pair->second & (~SignalLinkType::Required));
+}
+
 void Block::_mark_unprocessed()
 {
     _processed = false;
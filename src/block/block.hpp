@@ -22,7 +22,10 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <functional>
 #include <memory>
 #include <optional>
+#include <typeinfo>
 
+#include "src/block/archive.hpp"
+#include "src/block/sample_time.hpp"
 #include "src/helper/defs.hpp"
 #include "src/shared/named_object.hpp"
 #include "src/signal/array_signal.hpp"
@@ -46,6 +49,8 @@ class Block : public NamedObject
 public:
     static constexpr uint16_t NoIOLimit = uint16_t(-1);
 
+    // Required marks the signals that must be assigned before the block can be processed, i.e. the inputs the block has
+    // a direct feedthrough from. The simulators derive the processing order of the blocks from it.
     enum SignalLinkType : uint32_t
     {
         Input    = 1U << 0,
@@ -65,6 +70,36 @@ public:
     virtual void pre_step(double /*t*/) {}
     virtual void post_step(double /*t*/) {}
 
+    // A block with discontinuities declares zero-crossing functions of its signals. The simulators end a step where one
+    // changes sign, so that the block reacts to the event, e.g. in pre_step(), at the time it happens. zero_crossings()
+    // is called after the model is processed and writes num_zero_crossings() values.
+    virtual std::size_t num_zero_crossings() const { return 0; }
+    virtual void zero_crossings(double /*t*/, double* /*values*/) const {}
+
+    // The sample time of a submodel applies to the blocks in it with an inherited sample time. A leaf that still
+    // inherits its sample time is constant if it is time-invariant and all the leaves driving its inputs are constant,
+    // discrete if all the non-constant ones are discrete with the same sample time, and continuous otherwise.
+    void set_sample_time(const SampleTime& sample_time) { _sample_time = sample_time; }
+    const SampleTime& sample_time() const { return _sample_time; }
+
+    // whether the outputs only depend on the current inputs, and not on time or an internal state
+    virtual bool time_invariant() const { return false; }
+
+    // whether the outputs only depend on time, e.g. a source, so they are reused in the evaluations at the same time
+    virtual bool time_only() const { return false; }
+
+    // whether post_step() changes the outputs of the next evaluation, e.g. a memory, so that the steppers do not reuse
+    // the derivatives evaluated before it. A block that overrides post_step() for that must override this too.
+    virtual bool post_step_changes_outputs() const { return false; }
+
+    // writes the internal state of the block, e.g. the value of a memory, to a checkpoint or reads it back from one
+    virtual void serialize(Archive& /*ar*/) {}
+
+    // a held block is not activated and its outputs keep their values, set by the simulators between the sample hits
+    // of a discrete block
+    bool held() const { return _held; }
+    void set_held(bool held) { _held = held; }
+
     auto parent() -> auto { return _parent; }
     bool processed() const { return _processed; }
     bool connected() const { return _connected; }
@@ -123,8 +158,20 @@ protected:
     uint16_t _num_oports{NoIOLimit};
 
     bool _processed{false};
+    SampleTime _sample_time{SampleTime::inherited()};
+    bool _held{false};
+
     void link_signal(const Signal& sig, uint32_t types);
     SignalLinkPair* find_linked_signal(SignalImpl& impl);
+    void set_direct_feedthrough(const Signal& sig, bool direct_feedthrough);
+
+    // whether the block is of type T itself rather than of a subclass, which may override the activation function, e.g.
+    // so that time_invariant() or lower() of T do not carry over to the subclasses
+    template<typename T>
+    bool is_exact_type() const
+    {
+        return typeid(*this) == typeid(T);
+    }
 
     explicit Block(Submodel* parent = nullptr, std::string_view name = "", uint16_t num_iports = NoIOLimit,
                    uint16_t num_oports = NoIOLimit);
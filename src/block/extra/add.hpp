@@ -22,7 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef __POOYA_BLOCK_ADD_HPP__
 #define __POOYA_BLOCK_ADD_HPP__
 
+#include <type_traits>
+
 #include "src/block/singleo.hpp"
+#include "src/block/tape.hpp"
 #include "src/signal/array.hpp"
 
 namespace pooya
@@ -68,6 +71,24 @@ public:
         Base::_s_out = _ret;
     }
 
+    bool time_invariant() const override
+    {
+        return Base::template is_exact_type<AddT>();
+    }
+
+    bool lower([[maybe_unused]] Tape& tape) override
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            std::vector<Signal> inputs;
+            inputs.reserve(Base::_ibus->size());
+            for (const auto& sig : Base::_ibus) inputs.push_back(sig.second);
+            return Base::template is_exact_type<AddT>() &&
+                   tape.add_op(Tape::OpCode::Add, Base::_s_out, inputs, _initial);
+        }
+        return false;
+    }
+
 protected:
     T _initial;
     T _ret;
@@ -32,6 +32,12 @@ bool BusBlockBuilder::connect(const Bus& ibus, const Bus& obus)
         return false;
     }
 
+    // the actual work is done by the blocks built for the signals of the bus
+    for (auto& sig_type : _linked_signals)
+    {
+        sig_type.second &= ~SignalLinkType::Required;
+    }
+
     _blocks.reserve(ibus->size());
     visit_bus("", ibus);
 
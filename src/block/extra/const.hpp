@@ -22,7 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef __POOYA_BLOCK_CONST_HPP__
 #define __POOYA_BLOCK_CONST_HPP__
 
+#include <type_traits>
+
 #include "src/block/singleo.hpp"
+#include "src/block/tape.hpp"
 #include "src/signal/array.hpp"
 
 namespace pooya
@@ -37,6 +40,7 @@ public:
     explicit ConstT(typename Types<T>::SetValue value, Submodel* parent = nullptr, std::string_view name = "")
         : Base(parent, name, 0), _value(value)
     {
+        Base::_sample_time = SampleTime::constant();
     }
 
     void activation_function(double /*t*/) override
@@ -45,6 +49,16 @@ public:
         Base::_s_out = _value;
     }
 
+    bool lower([[maybe_unused]] Tape& tape) override
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            return Base::template is_exact_type<ConstT>() &&
+                   tape.add_op(Tape::OpCode::Const, Base::_s_out, {}, _value);
+        }
+        return false;
+    }
+
 protected:
     T _value;
 };
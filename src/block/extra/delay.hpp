@@ -53,9 +53,14 @@ public:
         _s_delay.reset(Base::input("delay"));
         _s_initial.reset(Base::input("initial"));
 
+        // the current input is only recorded in post_step
+        Base::set_direct_feedthrough(_s_x, false);
+
         return true;
     }
 
+    bool post_step_changes_outputs() const override { return true; }
+
     void post_step(double t) override
     {
         pooya_trace("block: " + Base::full_name().str());
@@ -114,6 +119,12 @@ public:
         }
     }
 
+    void serialize(Archive& ar) override
+    {
+        ar(_t);
+        ar(_x);
+    }
+
 protected:
     double _lifespan;
     std::vector<double> _t;
@@ -39,6 +39,8 @@ public:
     {
     }
 
+    bool post_step_changes_outputs() const override { return true; }
+
     void post_step(double t) override
     {
         pooya_trace("block: " + Base::full_name().str());
@@ -67,6 +69,14 @@ public:
         }
     }
 
+    void serialize(Archive& ar) override
+    {
+        ar(_first_step);
+        ar(_t);
+        ar(_x);
+        ar(_y);
+    }
+
 protected:
     bool _first_step{true};
     double _t;
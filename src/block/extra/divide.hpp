@@ -22,7 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef __POOYA_BLOCK_DIVIDE_HPP__
 #define __POOYA_BLOCK_DIVIDE_HPP__
 
+#include <type_traits>
+
 #include "src/block/singleo.hpp"
+#include "src/block/tape.hpp"
 #include "src/signal/array.hpp"
 
 namespace pooya
@@ -57,6 +60,21 @@ public:
         Base::_s_out = _s_x1 / _s_x2;
     }
 
+    bool time_invariant() const override
+    {
+        return Base::template is_exact_type<DivideT>();
+    }
+
+    bool lower([[maybe_unused]] Tape& tape) override
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            return Base::template is_exact_type<DivideT>() &&
+                   tape.add_op(Tape::OpCode::Divide, Base::_s_out, {_s_x1, _s_x2});
+        }
+        return false;
+    }
+
 protected:
     // input signals
     typename Types<T>::Signal _s_x1; // input 1
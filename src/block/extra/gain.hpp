@@ -22,7 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef __POOYA_BLOCK_GAIN_HPP__
 #define __POOYA_BLOCK_GAIN_HPP__
 
+#include <type_traits>
+
 #include "src/block/singleio.hpp"
+#include "src/block/tape.hpp"
 #include "src/signal/array.hpp"
 
 namespace pooya
@@ -42,6 +45,21 @@ public:
         Base::_s_out = _k * Base::_s_in->get_value();
     }
 
+    bool time_invariant() const override
+    {
+        return Base::template is_exact_type<GainT>();
+    }
+
+    bool lower([[maybe_unused]] Tape& tape) override
+    {
+        if constexpr (std::is_same_v<T, double> && std::is_same_v<GainType, double>)
+        {
+            return Base::template is_exact_type<GainT>() &&
+                   tape.add_op(Tape::OpCode::Gain, Base::_s_out, {Base::_s_in}, _k);
+        }
+        return false;
+    }
+
     typename Types<GainType>::GetValue gain() const { return _k; }
 
 protected:
@@ -56,6 +74,9 @@ using GainI = GainT<int, int>;
 
 #ifdef POOYA_ARRAY_SIGNAL
 using GainA = GainT<Array, double>;
+
+// one gain per element, e.g. a parameter that varies across the members of an ensemble
+using GainAA = GainT<Array, Array>;
 #endif // POOYA_ARRAY_SIGNAL
 
 } // namespace pooya
@@ -48,6 +48,12 @@ public:
         Base::_s_out->set(_value);
     }
 
+    void serialize(Archive& ar) override
+    {
+        ar(_value);
+        ar(_init);
+    }
+
 protected:
     T _value;
     bool _init{true};
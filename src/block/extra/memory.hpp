@@ -47,14 +47,14 @@ public:
             return false;
         }
 
-        if (auto* ptr = Base::find_linked_signal(Base::_s_in.impl()))
-        {
-            ptr->second = ptr->second & (~Base::SignalLinkType::Required);
-        }
+        // the output only depends on the input of the previous step
+        Base::set_direct_feedthrough(Base::_s_in, false);
 
         return true;
     }
 
+    bool post_step_changes_outputs() const override { return true; }
+
     void post_step(double /*t*/) override
     {
         pooya_trace("block: " + Base::full_name().str());
@@ -67,6 +67,8 @@ public:
         Base::_s_out = _value;
     }
 
+    void serialize(Archive& ar) override { ar(_value); }
+
 protected:
     T _value;
 };
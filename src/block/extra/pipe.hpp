@@ -22,7 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef __POOYA_BLOCK_PIPE_HPP__
 #define __POOYA_BLOCK_PIPE_HPP__
 
+#include <type_traits>
+
 #include "src/block/singleio.hpp"
+#include "src/block/tape.hpp"
 #include "src/signal/array.hpp"
 
 namespace pooya
@@ -41,6 +44,16 @@ public:
         pooya_trace("block: " + Base::full_name().str());
         Base::_s_out = Base::_s_in;
     }
+
+    bool lower([[maybe_unused]] Tape& tape) override
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            return Base::template is_exact_type<PipeT>() &&
+                   tape.add_op(Tape::OpCode::Copy, Base::_s_out, {Base::_s_in});
+        }
+        return false;
+    }
 };
 
 using Pipe = PipeT<double>;
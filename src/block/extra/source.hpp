@@ -46,6 +46,11 @@ public:
         Base::_s_out = _src_func(t);
     }
 
+    bool time_only() const override
+    {
+        return Base::template is_exact_type<SourceT>();
+    }
+
 protected:
     SourceFunction _src_func;
 };
@@ -44,6 +44,11 @@ public:
         _src_func(_obus, t);
     }
 
+    bool time_only() const override
+    {
+        return is_exact_type<Sources>();
+    }
+
 protected:
     SourcesFunction _src_func;
 };
@@ -81,6 +81,19 @@ public:
         }
     }
 
+    // the trigger, so that the reset is not delayed to the end of a long step
+    std::size_t num_zero_crossings() const override { return 1; }
+    void zero_crossings(double /*t*/, double* values) const override
+    {
+        values[0] = (_trigger->assigned() && _trigger->get_value()) ? 1.0 : -1.0;
+    }
+
+    void serialize(Archive& ar) override
+    {
+        Base::serialize(ar);
+        ar(_triggered);
+    }
+
 protected:
     BoolSignal _trigger;
     bool _triggered{false};
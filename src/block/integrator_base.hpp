@@ -38,6 +38,8 @@ public:
                              uint16_t num_oports = Block::NoIOLimit)
         : Base(parent, name, num_iports, num_oports), _value(ic)
     {
+        // a state variable is continuous even within a discrete submodel
+        Base::_sample_time = SampleTime::continuous();
     }
 
     bool connect(const Bus& ibus, const Bus& obus) override
@@ -50,10 +52,8 @@ public:
 
         auto s_in = Base::input(0);
         Base::_s_out->set_deriv_signal(s_in);
-        if (auto* ptr = Base::find_linked_signal(s_in.impl()))
-        {
-            ptr->second = ptr->second & (~Base::SignalLinkType::Required);
-        }
+        // the output is a state variable, the input is only used as its derivative
+        Base::set_direct_feedthrough(s_in, false);
 
         if (auto* ptr = Base::find_linked_signal(Base::_s_out.impl()))
         {
@@ -77,6 +77,8 @@ public:
         _value = Base::_s_out;
     }
 
+    void serialize(Archive& ar) override { ar(_value); }
+
 protected:
     T _value;
 };
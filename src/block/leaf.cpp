@@ -23,12 +23,19 @@ namespace pooya
 uint Leaf::process(double t, bool /*go_deep*/)
 {
     pooya_trace("block: " + full_name().str());
-    if (_processed || !ready_to_process())
+    if (_processed)
     {
         return 0;
     }
 
-    activation_function(t);
+    if (!_held)
+    {
+        if (!ready_to_process())
+        {
+            return 0;
+        }
+        activation_function(t);
+    }
 
     _processed = true;
     return 1;
@@ -23,6 +23,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 namespace pooya
 {
 
+class Tape;
+
 class Leaf : public Block
 {
 protected:
@@ -39,6 +41,10 @@ public:
     uint process(double t, bool go_deep = true) override;
 
     virtual void activation_function(double /*t*/) {}
+
+    // appends exactly one instruction equivalent to activation_function to the tape
+    // returns false if the leaf cannot be lowered, then it is called through the tape instead
+    virtual bool lower(Tape& /*tape*/) { return false; }
 }; // class Leaf
 
 } // namespace pooya
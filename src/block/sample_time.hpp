@@ -0,0 +1,89 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_BLOCK_SAMPLE_TIME_HPP__
+#define __POOYA_BLOCK_SAMPLE_TIME_HPP__
+
+#include <cmath>
+#include <limits>
+
+#include "src/helper/util.hpp"
+#include "src/helper/verify.hpp"
+
+namespace pooya
+{
+
+// When a block is evaluated. A continuous block is evaluated whenever the model is, including the intermediate
+// evaluations of the steppers. A discrete block is only evaluated at its sample hits, offset + k * period, and holds
+// its outputs in between. A constant block is evaluated once and holds its outputs until the parameters of the model
+// change. An inherited sample time is resolved by the simulators.
+class SampleTime
+{
+public:
+    static SampleTime continuous() { return SampleTime(0, 0); }
+    static SampleTime inherited() { return SampleTime(-1, 0); }
+    static SampleTime constant() { return SampleTime(std::numeric_limits<double>::infinity(), 0); }
+    static SampleTime discrete(double period, double offset = 0)
+    {
+        pooya_verify(period > 0, "the period of a discrete sample time must be positive!");
+        pooya_verify(std::isfinite(period), "the period of a discrete sample time must be finite!");
+        pooya_verify((offset >= 0) && (offset < period),
+                     "the offset of a discrete sample time must be in [0, period)!");
+        return SampleTime(period, offset);
+    }
+
+    bool is_continuous() const { return _period == 0; }
+    bool is_inherited() const { return _period < 0; }
+    bool is_discrete() const { return (_period > 0) && !is_constant(); }
+    bool is_constant() const { return std::isinf(_period); }
+
+    double period() const { return _period; }
+    double offset() const { return _offset; }
+
+    bool operator==(const SampleTime& other) const { return (_period == other._period) && (_offset == other._offset); }
+    bool operator!=(const SampleTime& other) const { return !(*this == other); }
+
+    // whether t is a sample hit of a discrete sample time, a constant sample time has none
+    bool hit(double t) const
+    {
+        if (is_constant()) return false;
+
+        const double n = std::round((t - _offset) / _period);
+        return std::abs(t - (_offset + n * _period)) <= _tol * _period;
+    }
+
+    // the first sample hit of a discrete sample time after t
+    double next_hit(double t) const
+    {
+        if (is_constant()) return _period;
+
+        const double n = hit(t) ? std::round((t - _offset) / _period) : std::floor((t - _offset) / _period);
+        return _offset + (n + 1) * _period;
+    }
+
+protected:
+    static constexpr double _tol{1e-9}; // relative to the period
+
+    double _period;
+    double _offset;
+
+    SampleTime(double period, double offset) : _period(period), _offset(offset) {}
+};
+
+} // namespace pooya
+
+#endif // __POOYA_BLOCK_SAMPLE_TIME_HPP__
@@ -40,7 +40,10 @@ public:
         pooya_trace("block: " + full_name().str());
         for (auto* block : _blocks)
         {
-            block->pre_step(t);
+            if (!block->held())
+            {
+                block->pre_step(t);
+            }
         }
     }
 
@@ -49,7 +52,10 @@ public:
         pooya_trace("block: " + full_name().str());
         for (auto* block : _blocks)
         {
-            block->post_step(t);
+            if (!block->held())
+            {
+                block->post_step(t);
+            }
         }
     }
 
@@ -0,0 +1,142 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "src/block/leaf.hpp"
+#include "src/block/tape.hpp"
+
+namespace pooya
+{
+
+void Tape::reset(double* arena, std::size_t size)
+{
+    pooya_trace0;
+
+    _arena      = arena;
+    _arena_size = size;
+    _instructions.clear();
+    _operands.clear();
+    _operand_signals.clear();
+}
+
+bool Tape::offset(const Signal& sig, uint32_t& offset) const
+{
+    auto* ps = dynamic_cast<const ScalarSignalImpl*>(&sig.impl());
+    if (!ps || (ps->storage() < _arena) || (ps->storage() >= _arena + _arena_size))
+    {
+        return false;
+    }
+
+    offset = static_cast<uint32_t>(ps->storage() - _arena);
+    return true;
+}
+
+bool Tape::add_op(OpCode op, const Signal& out, const std::vector<Signal>& inputs, double k)
+{
+    pooya_trace0;
+    pooya_debug_verify0(op != OpCode::Call);
+
+    Instruction ins{op, 0, static_cast<uint32_t>(_operands.size()), static_cast<uint32_t>(inputs.size()), k,
+                    static_cast<ScalarSignalImpl*>(&out.impl()), nullptr};
+    if (!offset(out, ins._out))
+    {
+        return false;
+    }
+
+    for (const auto& sig : inputs)
+    {
+        uint32_t off;
+        if (!offset(sig, off))
+        {
+            _operands.resize(ins._first);
+            _operand_signals.resize(ins._first);
+            return false;
+        }
+        _operands.push_back(off);
+        _operand_signals.push_back(static_cast<const ScalarSignalImpl*>(&sig.impl()));
+    }
+
+    _instructions.push_back(ins);
+    return true;
+}
+
+void Tape::add_call(Leaf& leaf)
+{
+    pooya_trace("block: " + leaf.full_name().str());
+    _instructions.push_back({OpCode::Call, 0, 0, 0, 0, nullptr, &leaf});
+}
+
+void Tape::run(double t, std::size_t begin, std::size_t end) const
+{
+    double* a = _arena;
+    for (auto k = begin; k < end; k++)
+    {
+        const auto& ins = _instructions[k];
+        if (ins._op == OpCode::Call)
+        {
+            if (!ins._leaf->held())
+            {
+                ins._leaf->activation_function(t);
+            }
+            continue;
+        }
+
+        const uint32_t* in = _operands.data() + ins._first;
+#if defined(POOYA_DEBUG)
+        for (uint32_t j = 0; j < ins._num_operands; j++)
+        {
+            const auto* sig = _operand_signals[ins._first + j];
+            pooya_verify(sig->assigned(), sig->name().str() + ": attempting to access an unassigned value!");
+        }
+#endif // defined(POOYA_DEBUG)
+
+        double v;
+        switch (ins._op)
+        {
+        case OpCode::Const:
+            v = ins._k;
+            break;
+        case OpCode::Copy:
+            v = a[in[0]];
+            break;
+        case OpCode::Gain:
+            v = ins._k * a[in[0]];
+            break;
+        case OpCode::Add:
+            v = ins._k;
+            for (uint32_t j = 0; j < ins._num_operands; j++) v += a[in[j]];
+            break;
+        case OpCode::Subtract:
+            v = a[in[0]] - a[in[1]];
+            break;
+        case OpCode::Multiply:
+            v = ins._k;
+            for (uint32_t j = 0; j < ins._num_operands; j++) v *= a[in[j]];
+            break;
+        case OpCode::Divide:
+            v = a[in[0]] / a[in[1]];
+            break;
+        default:
+            v = 0;
+            pooya_verify(false, "invalid tape instruction!");
+        }
+
+        a[ins._out] = v;
+        ins._out_sig->set_assigned();
+    }
+}
+
+} // namespace pooya
@@ -0,0 +1,89 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_BLOCK_TAPE_HPP__
+#define __POOYA_BLOCK_TAPE_HPP__
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "src/signal/scalar_signal.hpp"
+
+namespace pooya
+{
+
+class Leaf;
+
+// A flat list of instructions that replaces the activation functions of the leaves of a model. The built-in leaves
+// with scalar signals lower themselves to arithmetic instructions over the offsets of their signals in the value arena
+// of a simulator (see Leaf::lower), all the other leaves are called through the Call instruction.
+class Tape
+{
+public:
+    enum class OpCode : uint8_t
+    {
+        Call,     // leaf->activation_function(t), unless the leaf is held
+        Const,    // out = k
+        Copy,     // out = in[0]
+        Gain,     // out = k * in[0]
+        Add,      // out = k + in[0] + in[1] + ...
+        Subtract, // out = in[0] - in[1]
+        Multiply, // out = k * in[0] * in[1] * ...
+        Divide,   // out = in[0] / in[1]
+    };
+
+    struct Instruction
+    {
+        OpCode _op;
+        uint32_t _out;           // arena offset of the output
+        uint32_t _first;         // index of the first operand in _operands
+        uint32_t _num_operands;
+        double _k;
+        ScalarSignalImpl* _out_sig;
+        Leaf* _leaf;             // Call only
+    };
+
+    // starts over with the arena of a simulator, [arena, arena + size)
+    void reset(double* arena, std::size_t size);
+
+    // returns false if any of the signals is not a scalar signal of the arena
+    bool add_op(OpCode op, const Signal& out, const std::vector<Signal>& inputs, double k = 0);
+    bool add_op(OpCode op, const Signal& out, std::initializer_list<Signal> inputs, double k = 0)
+    {
+        return add_op(op, out, std::vector<Signal>(inputs), k);
+    }
+    void add_call(Leaf& leaf);
+
+    std::size_t size() const { return _instructions.size(); }
+
+    // executes the instructions [begin, end)
+    void run(double t, std::size_t begin, std::size_t end) const;
+
+protected:
+    double* _arena{nullptr};
+    std::size_t _arena_size{0};
+    std::vector<Instruction> _instructions;
+    std::vector<uint32_t> _operands;
+    std::vector<const ScalarSignalImpl*> _operand_signals; // for verifying the inputs are assigned
+
+    bool offset(const Signal& sig, uint32_t& offset) const;
+};
+
+} // namespace pooya
+
+#endif // __POOYA_BLOCK_TAPE_HPP__
@@ -43,7 +43,8 @@ struct PooyaTraceInfo
     std::string _msg;
 };
 
-extern std::vector<PooyaTraceInfo> pooya_trace_info;
+// every thread keeps its own traceback, e.g. the worker threads of a parallel simulator
+extern thread_local std::vector<PooyaTraceInfo> pooya_trace_info;
 
 class PooyaTracer
 {
@@ -62,7 +62,7 @@ public:
                                                            std::to_string(_size) + " vs " +
                                                            std::to_string(value.rows()) + ")!");
         _array_value = value;
-        _assigned    = true;
+        _stamp       = *_epoch;
     }
 
 protected:
@@ -50,7 +50,7 @@ public:
         pooya_trace("value: " + std::to_string(value));
         pooya_debug_verify(!assigned(), name().str() + ": re-assignment is prohibited!");
         _bool_value = value;
-        _assigned   = true;
+        _stamp      = *_epoch;
     }
 
 protected:
@@ -42,19 +42,31 @@ public:
     {
         pooya_trace0;
         pooya_debug_verify(assigned(), name().str() + ": attempting to access an unassigned value!");
-        return _scalar_value;
+        return *_scalar_ptr;
     }
 
     void set_value(double value)
     {
         pooya_trace("value: " + std::to_string(value));
         pooya_debug_verify(!assigned(), name().str() + ": re-assignment is prohibited!");
-        _scalar_value = value;
-        _assigned     = true;
+        *_scalar_ptr = value;
+        _stamp       = *_epoch;
+    }
+
+    const double* storage() const { return _scalar_ptr; }
+
+    // relocate the value to an external storage, e.g. a slot of the value arena of a simulator
+    // nullptr moves the value back to the signal's own storage
+    void bind_storage(double* storage)
+    {
+        double* ptr = storage ? storage : &_scalar_value;
+        *ptr        = *_scalar_ptr;
+        _scalar_ptr = ptr;
     }
 
 protected:
-    double _scalar_value;
+    double _scalar_value{0};
+    double* _scalar_ptr{&_scalar_value};
 };
 
 class ScalarSignal : public SignalT<double>
@@ -18,7 +18,10 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_SIGNAL_VALUE_SIGNAL_HPP__
 #define __POOYA_SIGNAL_VALUE_SIGNAL_HPP__
 
+#include <cstdint>
+
 #include "signal.hpp"
+#include "src/helper/verify.hpp"
 
 namespace pooya
 {
@@ -29,11 +32,33 @@ public:
     using Base = SignalImpl;
     using Ptr  = std::shared_ptr<ValueSignalImpl>;
 
-    void clear() { _assigned = false; }
-    bool assigned() const { return _assigned; }
+    void clear() { _stamp = 0; }
+    bool assigned() const { return _stamp == *_epoch; }
+
+    // mark the value as assigned when it is written directly to the storage, e.g. by a simulator
+    void set_assigned()
+    {
+        pooya_debug_verify(!assigned(), name().str() + ": re-assignment is prohibited!");
+        _stamp = *_epoch;
+    }
+
+    // A value is assigned in the current epoch of the signal. Binding it to an external epoch, e.g. of a simulator,
+    // lets the owner of the epoch clear all the signals bound to it at once by incrementing it. An epoch starts at 1
+    // and only increases. nullptr binds the signal back to its own epoch.
+    void bind_epoch(const uint64_t* epoch)
+    {
+        const bool was_assigned = assigned();
+        _epoch                  = epoch ? epoch : &_own_epoch;
+        _stamp                  = was_assigned ? *_epoch : 0;
+    }
+
+    const uint64_t* epoch() const { return _epoch; }
 
 protected:
-    bool _assigned{false}; // has the value been assigned?
+    static constexpr uint64_t _own_epoch{1};
+
+    const uint64_t* _epoch{&_own_epoch};
+    uint64_t _stamp{0}; // the epoch the value was assigned in, 0 if it is not assigned
 
     ValueSignalImpl(std::string_view name) : SignalImpl(name) {}
 };
@@ -0,0 +1,316 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "algebraic_loop.hpp"
+#include "src/helper/util.hpp"
+
+namespace pooya
+{
+
+AlgebraicLoop::AlgebraicLoop(const BlockGraph& graph, const std::vector<std::size_t>& loop)
+    : Leaf(nullptr, "algebraic_loop")
+{
+    pooya_trace0;
+
+    _valid = tear(graph, loop);
+    if (!_valid)
+    {
+        return;
+    }
+
+    // as a leaf, the loop outputs the outputs of its leaves and requires what they require from outside the loop
+    std::unordered_set<const ValueSignalImpl*> outputs;
+    for (auto* leaf : _leaves)
+    {
+        for (const auto& [sig, type] : leaf->linked_signals())
+        {
+            if ((type & SignalLinkType::Output) && outputs.insert(sig.get()).second)
+            {
+                _outputs.push_back(sig.get());
+                link_signal(Signal(*sig), SignalLinkType::Output);
+            }
+        }
+    }
+    for (auto* leaf : _leaves)
+    {
+        for (const auto& [sig, type] : leaf->linked_signals())
+        {
+            if ((type & SignalLinkType::Input) && !outputs.count(sig.get()))
+            {
+                link_signal(Signal(*sig), type & (SignalLinkType::Input | SignalLinkType::Required));
+            }
+        }
+    }
+
+    const auto n = static_cast<Eigen::Index>(_torn.size());
+    _x.resize(n);
+    _fx.resize(n);
+    _g.resize(n);
+    _dx.resize(n);
+    _x1.resize(n);
+    _fx1.resize(n);
+    _g1.resize(n);
+    _J.resize(n, n);
+    _lu = Eigen::PartialPivLU<Eigen::MatrixXd>(n);
+}
+
+bool AlgebraicLoop::tear(const BlockGraph& graph, const std::vector<std::size_t>& loop)
+{
+    pooya_trace0;
+
+    // the signals the leaves of the loop require from each other
+    struct Link
+    {
+        ValueSignalImpl* _sig;
+        std::size_t _producer;
+        std::size_t _consumer;
+    };
+
+    std::unordered_map<const ValueSignalImpl*, std::vector<std::size_t>> producers;
+    for (std::size_t k = 0; k < loop.size(); k++)
+    {
+        for (const auto& [sig, type] : graph.leaves()[loop[k]]->linked_signals())
+        {
+            if (type & SignalLinkType::Output)
+            {
+                producers[sig.get()].push_back(k);
+            }
+        }
+    }
+
+    std::vector<Link> links;
+    for (std::size_t k = 0; k < loop.size(); k++)
+    {
+        for (const auto& [sig, type] : graph.leaves()[loop[k]]->linked_signals())
+        {
+            if (!(type & SignalLinkType::Required))
+            {
+                continue;
+            }
+            auto it = producers.find(sig.get());
+            if (it == producers.end())
+            {
+                continue;
+            }
+            for (auto p : it->second)
+            {
+                if (p != k)
+                {
+                    links.push_back({sig.get(), p, k});
+                }
+            }
+        }
+    }
+
+    std::vector<ValueSignalImpl*> torn;
+    std::vector<std::size_t> order;
+    std::vector<std::size_t> num_preds(loop.size());
+    std::vector<std::vector<std::size_t>> succs(loop.size());
+    for (;;)
+    {
+        // a torn signal is required by the leaves before it is output
+        for (std::size_t k = 0; k < loop.size(); k++)
+        {
+            num_preds[k] = 0;
+            succs[k].clear();
+        }
+        for (const auto& link : links)
+        {
+            const bool is_torn = std::find(torn.begin(), torn.end(), link._sig) != torn.end();
+            const auto from    = is_torn ? link._consumer : link._producer;
+            const auto to      = is_torn ? link._producer : link._consumer;
+            succs[from].push_back(to);
+            num_preds[to]++;
+        }
+
+        // Kahn's algorithm
+        order.clear();
+        for (std::size_t k = 0; k < loop.size(); k++)
+        {
+            if (num_preds[k] == 0)
+            {
+                order.push_back(k);
+            }
+        }
+        for (std::size_t n = 0; n < order.size(); n++)
+        {
+            for (auto s : succs[order[n]])
+            {
+                if (--num_preds[s] == 0)
+                {
+                    order.push_back(s);
+                }
+            }
+        }
+
+        if (order.size() == loop.size())
+        {
+            break;
+        }
+
+        // tears the scalar signal with a single producer that the most links among the unordered leaves carry
+        std::unordered_map<const ValueSignalImpl*, std::size_t> counts;
+        ValueSignalImpl* best{nullptr};
+        for (const auto& link : links)
+        {
+            if ((num_preds[link._producer] == 0) || (num_preds[link._consumer] == 0) ||
+                (producers[link._sig].size() != 1) || !dynamic_cast<ScalarSignalImpl*>(link._sig) ||
+                (std::find(torn.begin(), torn.end(), link._sig) != torn.end()))
+            {
+                continue;
+            }
+            const auto count = ++counts[link._sig];
+            if (!best || (count > counts[best]))
+            {
+                best = link._sig;
+            }
+        }
+
+        if (!best)
+        {
+            return false;
+        }
+        torn.push_back(best);
+    }
+
+    std::vector<std::size_t> position(loop.size());
+    for (std::size_t n = 0; n < order.size(); n++)
+    {
+        _leaves.push_back(graph.leaves()[loop[order[n]]]);
+        position[order[n]] = n;
+    }
+
+    _torn_outputs.resize(_leaves.size());
+    for (auto* sig : torn)
+    {
+        _torn_outputs[position[producers[sig].front()]].push_back(_torn.size());
+        _torn.push_back(static_cast<ScalarSignalImpl*>(sig));
+    }
+
+    return true;
+}
+
+void AlgebraicLoop::evaluate(double t, const Eigen::VectorXd& x, Eigen::VectorXd& fx)
+{
+    pooya_trace("block: " + full_name().str());
+
+    for (auto* sig : _outputs)
+    {
+        sig->clear();
+    }
+    for (std::size_t k = 0; k < _torn.size(); k++)
+    {
+        _torn[k]->set_value(x[k]);
+    }
+
+    for (std::size_t n = 0; n < _leaves.size(); n++)
+    {
+        auto* leaf = _leaves[n];
+
+        // the leaves that require the torn signals this leaf outputs are processed already
+        for (auto k : _torn_outputs[n])
+        {
+            _torn[k]->clear();
+        }
+
+        leaf->_mark_unprocessed();
+        leaf->process(t, false);
+        pooya_verify(leaf->processed(), leaf->full_name().str() + ": not ready to be processed in an algebraic loop!");
+    }
+
+    for (std::size_t k = 0; k < _torn.size(); k++)
+    {
+        fx[k] = _torn[k]->get_value();
+    }
+    _num_evaluations++;
+}
+
+void AlgebraicLoop::update_jacobian(double t)
+{
+    pooya_trace("block: " + full_name().str());
+
+    // _fx is evaluated at _x
+    for (Eigen::Index k = 0; k < _x.size(); k++)
+    {
+        _x1     = _x;
+        _x1[k] += _sqrt_eps * std::max(std::abs(_x[k]), 1.0);
+
+        const double dx = _x1[k] - _x[k];
+        evaluate(t, _x1, _fx1);
+        _J.col(k) = (_fx1 - _fx) / dx;
+    }
+    _J.diagonal().array() -= 1;
+
+    _lu.compute(_J);
+    _jacobian_valid = true;
+}
+
+bool AlgebraicLoop::converged() const
+{
+    return (_g.array().abs() <= _tol * (1 + _x.array().abs())).all();
+}
+
+void AlgebraicLoop::activation_function(double t)
+{
+    pooya_trace("block: " + full_name().str());
+
+    // the solution of the previous activation is the initial guess
+    for (std::size_t k = 0; k < _torn.size(); k++)
+    {
+        _x[k] = *_torn[k]->storage();
+    }
+    evaluate(t, _x, _fx);
+    _g = _fx - _x;
+
+    for (std::size_t iter = 0; !converged(); iter++)
+    {
+        pooya_verify(iter < _max_iterations, full_name().str() + ": the algebraic loop did not converge!");
+
+        const bool fresh = !_jacobian_valid;
+        if (fresh)
+        {
+            update_jacobian(t);
+        }
+        _dx = _lu.solve(_g);
+
+        // halves the Newton step until it reduces the residual enough
+        const double norm = _g.norm();
+        for (double damping = 1;; damping /= 2)
+        {
+            _x1 = _x - damping * _dx;
+            evaluate(t, _x1, _fx1);
+            _g1 = _fx1 - _x1;
+            if ((_g1.norm() <= (1 - damping / 4) * norm) || (damping <= _min_damping))
+            {
+                break;
+            }
+        }
+
+        // a Jacobian from an earlier iteration that converges slowly is replaced
+        _jacobian_valid = fresh || (_g1.norm() <= norm / 2);
+
+        _x.swap(_x1);
+        _fx.swap(_fx1);
+        _g.swap(_g1);
+    }
+}
+
+} // namespace pooya
@@ -0,0 +1,91 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_ALGEBRAIC_LOOP_HPP__
+#define __POOYA_SOLVER_ALGEBRAIC_LOOP_HPP__
+
+#include <cstddef>
+#include <vector>
+
+#include "Eigen/LU"
+
+#include "block_graph.hpp"
+#include "src/block/leaf.hpp"
+#include "src/signal/scalar_signal.hpp"
+
+namespace pooya
+{
+
+// A cycle of direct feedthroughs between leaves, i.e. an algebraic loop of the BlockGraph, that is processed as one
+// leaf. The loop is torn at a few scalar signals: given guesses of their values, the leaves of the loop are processed
+// in an order in which the leaves that require a torn signal come before the one that outputs it, which yields new
+// values of the torn signals. The guesses that reproduce themselves are found with a damped Newton iteration. Its
+// Jacobian is approximated with forward differences and kept, also across activations, as long as it reduces the
+// residual well.
+class AlgebraicLoop : public Leaf
+{
+public:
+    AlgebraicLoop(const BlockGraph& graph, const std::vector<std::size_t>& loop);
+
+    // false if the loop cannot be torn at scalar signals, then it cannot be solved
+    bool valid() const { return _valid; }
+
+    const std::vector<Leaf*>& leaves() const { return _leaves; } // in the processing order
+    const std::vector<ScalarSignalImpl*>& torn_signals() const { return _torn; }
+
+    // the number of times the leaves of the loop were processed
+    std::size_t num_evaluations() const { return _num_evaluations; }
+
+    void activation_function(double t) override;
+
+protected:
+    static constexpr double _tol{1e-10};          // relative to the magnitude of the torn signals, at least 1
+    static constexpr double _min_damping{1.0 / 16};
+    static constexpr std::size_t _max_iterations{50};
+    static constexpr double _sqrt_eps{1.4901161193847656e-08}; // sqrt(std::numeric_limits<double>::epsilon())
+
+    std::vector<Leaf*> _leaves;
+    std::vector<ScalarSignalImpl*> _torn;
+    std::vector<std::vector<std::size_t>> _torn_outputs; // the torn signals each leaf outputs
+    std::vector<ValueSignalImpl*> _outputs;              // the outputs of all the leaves
+    bool _valid{false};
+    std::size_t _num_evaluations{0};
+
+    Eigen::VectorXd _x;  // the guesses
+    Eigen::VectorXd _fx; // the torn signals the guesses yield
+    Eigen::VectorXd _g;  // the residual, _fx - _x
+    Eigen::VectorXd _dx;
+    Eigen::VectorXd _x1;
+    Eigen::VectorXd _fx1;
+    Eigen::VectorXd _g1;
+    Eigen::MatrixXd _J; // the Jacobian of the residual
+    Eigen::PartialPivLU<Eigen::MatrixXd> _lu;
+    bool _jacobian_valid{false};
+
+    // chooses the torn signals and the processing order, returns false if there is no such choice
+    bool tear(const BlockGraph& graph, const std::vector<std::size_t>& loop);
+
+    // processes the leaves of the loop with the torn signals set to x and returns their new values in fx
+    void evaluate(double t, const Eigen::VectorXd& x, Eigen::VectorXd& fx);
+
+    void update_jacobian(double t);
+    bool converged() const;
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_ALGEBRAIC_LOOP_HPP__
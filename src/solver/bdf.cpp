@@ -0,0 +1,267 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "bdf.hpp"
+
+namespace pooya
+{
+
+void Bdf::init(std::size_t num_states)
+{
+    _controller.init(num_states);
+    _jac.init(num_states);
+    _refresh_jac = false;
+    _accepted    = true;
+    _failed      = false;
+
+    _t_hist.resize(max_order + 1);
+    _v_hist.resize(max_order + 1);
+    for (auto& v : _v_hist)
+    {
+        v.resize(num_states);
+    }
+    _num_hist = 0;
+
+    _v_pending.resize(num_states);
+    _pending = false;
+
+    _f0.resize(num_states);
+    _pred.resize(num_states);
+    _S.resize(num_states);
+    _Y.resize(num_states);
+    _F.resize(num_states);
+    _D.resize(num_states);
+    _dd.resize(max_order + 2);
+    for (auto& v : _dd)
+    {
+        v.resize(num_states);
+    }
+}
+
+bool Bdf::update_history(double t0, const Array& v0)
+{
+    pooya_trace0;
+
+    if (_pending && (t0 == _t_pending) && (v0 == _v_pending).all())
+    {
+        // the last step is accepted
+        std::rotate(_t_hist.begin(), _t_hist.end() - 1, _t_hist.end());
+        std::rotate(_v_hist.begin(), _v_hist.end() - 1, _v_hist.end());
+        _t_hist[0] = _t_pending;
+        _v_hist[0].swap(_v_pending);
+        _num_hist = std::min(_num_hist + 1, _v_hist.size());
+        _pending  = false;
+        return true;
+    }
+    _pending = false;
+
+    if ((_num_hist > 0) && (t0 == _t_hist[0]) && (v0 == _v_hist[0]).all())
+    {
+        // a rejected step being retried
+        return true;
+    }
+
+    _t_hist[0]      = t0;
+    _v_hist[0]      = v0;
+    _num_hist       = 1;
+    _order          = 1;
+    _steps_at_order = 0;
+    return false;
+}
+
+void Bdf::predict(std::size_t k, double t1)
+{
+    pooya_trace0;
+
+    if (_num_hist == 1)
+    {
+        _pred = _v_hist[0] + (t1 - _t_hist[0]) * _f0;
+        return;
+    }
+
+    // the Newton form of the polynomial
+    for (std::size_t i = 0; i <= k; i++)
+    {
+        _dd[i] = _v_hist[i];
+    }
+    for (std::size_t l = 1; l <= k; l++)
+    {
+        for (std::size_t i = k; i >= l; i--)
+        {
+            _dd[i] = (_dd[i] - _dd[i - 1]) / (_t_hist[i] - _t_hist[i - l]);
+        }
+    }
+
+    _pred = _dd[k];
+    for (std::size_t i = k; i-- > 0;)
+    {
+        _pred = _dd[i] + (t1 - _t_hist[i]) * _pred;
+    }
+}
+
+double Bdf::coefficients(std::size_t k, double t1)
+{
+    pooya_trace0;
+
+    // the derivative of the polynomial that interpolates the new solution at t1 and the solutions in the history
+    double alpha0{0};
+    _S.setZero();
+    for (std::size_t j = 0; j < k; j++)
+    {
+        alpha0 += 1 / (t1 - _t_hist[j]);
+
+        double num = 1;
+        double den = _t_hist[j] - t1;
+        for (std::size_t m = 0; m < k; m++)
+        {
+            if (m != j)
+            {
+                num *= t1 - _t_hist[m];
+                den *= _t_hist[j] - _t_hist[m];
+            }
+        }
+        _S += (num / den) * _v_hist[j];
+    }
+
+    return 1 / alpha0;
+}
+
+double Bdf::backward_difference_norm(std::size_t n, double h)
+{
+    pooya_trace0;
+
+    // the divided difference of the new solution and the last n solutions, scaled to a backward difference with step h
+    auto t = [&](std::size_t i) -> double { return i == 0 ? _t_pending : _t_hist[i - 1]; };
+
+    _dd[0] = _Y;
+    for (std::size_t i = 1; i <= n; i++)
+    {
+        _dd[i] = _v_hist[i - 1];
+    }
+    double scale = 1;
+    for (std::size_t l = 1; l <= n; l++)
+    {
+        for (std::size_t i = n; i >= l; i--)
+        {
+            _dd[i] = (_dd[i] - _dd[i - 1]) / (t(i) - t(i - l));
+        }
+        scale *= l * h;
+    }
+
+    _D = scale * _dd[n];
+    return _controller.error_norm(_D, _v_hist[0], _Y);
+}
+
+double Bdf::next_order(std::size_t k, double err, double h)
+{
+    pooya_trace0;
+
+    _steps_at_order++;
+
+    std::size_t order = k;
+    double factor     = 0.9 * std::pow(err, -1.0 / (k + 1));
+
+    // a lower order
+    if ((k > 1) && (_num_hist >= k))
+    {
+        const double err_down    = backward_difference_norm(k, h) / k;
+        const double factor_down = 0.9 / 1.3 * std::pow(err_down, -1.0 / k);
+        if (factor_down > factor)
+        {
+            order  = k - 1;
+            factor = factor_down;
+        }
+    }
+
+    // a higher order, once a few steps are taken with this one
+    if ((order == k) && (k < max_order) && (_num_hist >= k + 2) && (_steps_at_order > k + 1))
+    {
+        const double err_up    = backward_difference_norm(k + 2, h) / (k + 2);
+        const double factor_up = 0.9 / 1.4 * std::pow(err_up, -1.0 / (k + 2));
+        if (factor_up > factor)
+        {
+            order  = k + 1;
+            factor = factor_up;
+        }
+    }
+
+    if (order != _order)
+    {
+        _order          = order;
+        _steps_at_order = 0;
+    }
+
+    factor = std::min(2.0, std::max(0.2, factor));
+    if ((factor > 1) && (factor < 1.2))
+    {
+        // keep the Newton matrix
+        factor = 1;
+    }
+
+    return factor;
+}
+
+bool Bdf::interpolate(double t, Array& v) const
+{
+    pooya_trace0;
+
+    if (!_pending)
+    {
+        return false;
+    }
+
+    // the Lagrange form of the polynomial
+    const std::size_t k = std::min(_order, _num_hist);
+    auto t_at           = [&](std::size_t i) -> double { return i == 0 ? _t_pending : _t_hist[i - 1]; };
+    auto v_at           = [&](std::size_t i) -> const Array& { return i == 0 ? _v_pending : _v_hist[i - 1]; };
+
+    v.setZero();
+    for (std::size_t i = 0; i <= k; i++)
+    {
+        double l = 1;
+        for (std::size_t m = 0; m <= k; m++)
+        {
+            if (m != i)
+            {
+                l *= (t - t_at(m)) / (t_at(i) - t_at(m));
+            }
+        }
+        v += l * v_at(i);
+    }
+    return true;
+}
+
+void Bdf::serialize(Archive& ar)
+{
+    pooya_trace0;
+
+    _controller.serialize(ar);
+    ar(_accepted);
+    ar(_order);
+    ar(_steps_at_order);
+    ar(_t_hist);
+    ar(_v_hist);
+    ar(_num_hist);
+    ar(_t_pending);
+    ar(_v_pending);
+    ar(_pending);
+    ar(_f0);
+
+    _refresh_jac = _refresh_jac || ar.loading();
+}
+
+} // namespace pooya
@@ -0,0 +1,224 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_BDF_HPP__
+#define __POOYA_SOLVER_BDF_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "jacobian.hpp"
+#include "step_size_controller.hpp"
+#include "stepper.hpp"
+
+namespace pooya
+{
+
+// Variable order (1 to 5), variable step backward differentiation formulas for stiff models.
+//
+// The formula of order k is derived from the polynomial that interpolates the new solution and the last k accepted
+// ones, so the coefficients follow the actual step sizes. The implicit equation is solved with a simplified Newton
+// iteration, started from the extrapolation of the last k + 1 solutions. The difference between the two estimates the
+// local error, and the estimates for orders k - 1 and k + 1 choose the order of the next step.
+//
+// The Jacobian is approximated with finite differences and kept from one step to the next, as is the LU factorization
+// of the Newton matrix as long as the step size and order change it by less than 30%. The Jacobian is evaluated again
+// only when the Newton iteration fails to converge.
+class Bdf : public StepperT<Bdf>
+{
+protected:
+    static constexpr std::size_t max_order = 5;
+
+    StepSizeController _controller;
+    Jacobian _jac;
+    bool _refresh_jac{false};
+    bool _accepted{true};
+    bool _failed{false}; // whether the Newton iteration of the last step did not converge
+    std::size_t _order{1};
+    std::size_t _steps_at_order{0};
+
+    // the accepted solutions, the most recent first
+    std::vector<double> _t_hist;
+    std::vector<Array> _v_hist;
+    std::size_t _num_hist{0};
+
+    // the solution of the last step, which becomes a part of the history if the next step starts from it
+    double _t_pending{0};
+    Array _v_pending;
+    bool _pending{false};
+
+    Array _f0;   // the derivative at the only solution in the history
+    Array _pred; // the predicted solution
+    Array _S;    // the contribution of the history to the formula
+    Array _Y;    // the Newton iterate
+    Array _F;
+    Array _D;
+    std::vector<Array> _dd; // divided differences
+
+    // returns false if the history is reset to (t0, v0)
+    bool update_history(double t0, const Array& v0);
+
+    // extrapolates the last k + 1 solutions to t1
+    void predict(std::size_t k, double t1);
+
+    // computes _S for the formula of order k and returns gamma
+    double coefficients(std::size_t k, double t1);
+
+    // the RMS norm of the n-th backward difference of the solutions, the new one included
+    double backward_difference_norm(std::size_t n, double h);
+
+    // chooses the order of the next step and returns the ratio of the next step size to h
+    double next_order(std::size_t k, double err, double h);
+
+public:
+    explicit Bdf(double abs_tol = 1e-6, double rel_tol = 1e-3) : _controller(max_order, abs_tol, rel_tol) {}
+
+    StepSizeController& controller() { return _controller; }
+
+    bool adaptive() const override { return true; }
+    bool accepted(double /*h*/, double /*new_h*/) const override { return _accepted; }
+    bool failed() const override { return _failed; }
+
+    // the history does not carry over a change of the derivatives, the next step starts over with backward Euler
+    void model_changed() override { _pending = false; }
+
+    void init(std::size_t num_states) override;
+    void set_jacobian_pattern(const JacobianPattern* pattern) override { _jac.set_pattern(pattern); }
+
+    // the Jacobian is evaluated again after loading
+    void serialize(Archive& ar) override;
+
+    std::size_t order() const { return _order; }
+
+    // the polynomial of the last accepted step, through its solution and the last ones in the history
+    bool interpolate(double t, Array& v) const override;
+
+    template<typename Callback>
+    void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+    {
+        pooya_trace0;
+        const double h = t1 - t0;
+
+        if (static_cast<std::size_t>(v0.size()) != _jac.size())
+        {
+            init(v0.size());
+        }
+
+        if (!update_history(t0, v0))
+        {
+            // start over with the backward Euler method
+            _f0 = f(t0, v0);
+        }
+
+        const std::size_t k = (_num_hist > 1) ? std::min(_order, _num_hist - 1) : 1;
+        predict(k, t1);
+        const double gamma = coefficients(k, t1);
+
+        // the simplified Newton iteration on y - gamma * f(t1, y) + gamma * s = 0
+        bool converged  = false;
+        bool jac_is_new = false;
+        while (!converged)
+        {
+            _Y = _pred;
+            double dnorm_prev{0};
+            for (int it = 0; it < 4; it++)
+            {
+                _F = f(t1, _Y);
+                if (it == 0 && (!_jac.valid() || (_refresh_jac && !jac_is_new)))
+                {
+                    _jac.evaluate(f, t1, _Y, _F, _controller.abs_tol());
+                    _refresh_jac = false;
+                    jac_is_new   = true;
+                }
+                if (!_jac.factorized() || (std::abs(gamma / _jac.gamma() - 1) > 0.3))
+                {
+                    _jac.factorize(gamma);
+                }
+
+                _D = gamma * (_F - _S) - _Y;
+                _jac.solve(_D);
+                _Y += _D;
+
+                const double dnorm = _controller.error_norm(_D, _Y, _Y);
+                if (dnorm <= 1e-3)
+                {
+                    converged = true;
+                    break;
+                }
+                if (it > 0)
+                {
+                    const double rate = dnorm / dnorm_prev;
+                    if (rate >= 0.9)
+                    {
+                        break;
+                    }
+                    if (rate / (1 - rate) * dnorm <= 0.1)
+                    {
+                        converged = true;
+                        break;
+                    }
+                }
+                dnorm_prev = dnorm;
+            }
+
+            if (!converged)
+            {
+                if (jac_is_new)
+                {
+                    break;
+                }
+                // try again with a new Jacobian
+                _refresh_jac = true;
+            }
+        }
+
+        if (!converged)
+        {
+            // the iterate is no solution, and must not be accepted even at the minimum step size
+            v1        = v0;
+            _accepted = false;
+            _failed   = true;
+            new_h     = h / 4;
+            return;
+        }
+
+        v1      = _Y;
+        _failed = false;
+
+        // the local error
+        _D         = _Y - _pred;
+        double err = _controller.error_norm(_D, v0, _Y) / ((_num_hist > 1) ? k + 1 : 1);
+        if (err > 1)
+        {
+            _accepted = false;
+            new_h     = h * std::max(0.2, 0.9 * std::pow(err, -1.0 / (k + 1)));
+            return;
+        }
+
+        _accepted  = true;
+        _pending   = true;
+        _t_pending = t1;
+        _v_pending = _Y;
+
+        new_h = h * next_order(k, err, h);
+    }
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_BDF_HPP__
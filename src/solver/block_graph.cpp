@@ -0,0 +1,242 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include "block_graph.hpp"
+#include "src/block/leaf.hpp"
+#include "src/helper/trace.hpp"
+#include "src/signal/array_signal.hpp"
+#include "src/signal/scalar_signal.hpp"
+
+namespace pooya
+{
+
+namespace
+{
+
+// the state variables are assigned by the simulators before any leaf is processed, even though a leaf outputs them
+bool state_variable(const ValueSignalImpl* sig)
+{
+    if (const auto* ps = dynamic_cast<const ScalarSignalImpl*>(sig); ps)
+    {
+        return ps->state_variable();
+    }
+#ifdef POOYA_ARRAY_SIGNAL
+    if (const auto* pa = dynamic_cast<const ArraySignalImpl*>(sig); pa)
+    {
+        return pa->state_variable();
+    }
+#endif // POOYA_ARRAY_SIGNAL
+    return false;
+}
+
+} // namespace
+
+BlockGraph::BlockGraph(Block& model)
+{
+    pooya_trace("model: " + model.full_name().str());
+
+    model.visit(
+        [&](Block& block, uint32_t /*level*/) -> bool
+        {
+            if (auto* leaf = dynamic_cast<Leaf*>(&block); leaf)
+            {
+                _leaves.push_back(leaf);
+            }
+            return true;
+        },
+        0);
+
+    std::unordered_map<const ValueSignalImpl*, std::vector<std::size_t>> producers;
+    for (std::size_t k = 0; k < _leaves.size(); k++)
+    {
+        for (const auto& [sig, type] : _leaves[k]->linked_signals())
+        {
+            if ((type & Block::SignalLinkType::Output) && !state_variable(sig.get()))
+            {
+                producers[sig.get()].push_back(k);
+            }
+        }
+    }
+
+    _dependencies.resize(_leaves.size());
+    _dependents.resize(_leaves.size());
+    for (std::size_t k = 0; k < _leaves.size(); k++)
+    {
+        auto& deps = _dependencies[k];
+        for (const auto& [sig, type] : _leaves[k]->linked_signals())
+        {
+            if (!(type & Block::SignalLinkType::Required))
+            {
+                continue;
+            }
+            auto it = producers.find(sig.get());
+            if (it == producers.end())
+            {
+                continue;
+            }
+            for (auto p : it->second)
+            {
+                if ((p != k) && (std::find(deps.begin(), deps.end(), p) == deps.end()))
+                {
+                    deps.push_back(p);
+                    _dependents[p].push_back(k);
+                }
+            }
+        }
+    }
+}
+
+bool BlockGraph::topological_order(std::vector<std::size_t>& order) const
+{
+    pooya_trace0;
+
+    // every leaf is a node of its own
+    std::vector<std::size_t> node(_leaves.size());
+    for (std::size_t k = 0; k < _leaves.size(); k++)
+    {
+        node[k] = k;
+    }
+    return topological_order(node, _leaves.size(), order);
+}
+
+bool BlockGraph::topological_order(const std::vector<std::size_t>& node, std::size_t num_nodes,
+                                   std::vector<std::size_t>& order) const
+{
+    pooya_trace0;
+
+    std::vector<std::vector<std::size_t>> dependents(num_nodes);
+    std::vector<std::size_t> num_deps(num_nodes, 0);
+    for (std::size_t k = 0; k < _leaves.size(); k++)
+    {
+        for (auto d : _dependents[k])
+        {
+            if (node[d] != node[k])
+            {
+                dependents[node[k]].push_back(node[d]);
+                num_deps[node[d]]++;
+            }
+        }
+    }
+
+    // Kahn's algorithm, ties are resolved in favor of the order of the nodes
+    order.clear();
+    order.reserve(num_nodes);
+    for (std::size_t n = 0; n < num_nodes; n++)
+    {
+        if (num_deps[n] == 0)
+        {
+            order.push_back(n);
+        }
+    }
+
+    for (std::size_t n = 0; n < order.size(); n++)
+    {
+        for (auto d : dependents[order[n]])
+        {
+            if (--num_deps[d] == 0)
+            {
+                order.push_back(d);
+            }
+        }
+    }
+
+    return order.size() == num_nodes;
+}
+
+void BlockGraph::algebraic_loops(std::vector<std::vector<std::size_t>>& loops) const
+{
+    pooya_trace0;
+
+    // Tarjan's algorithm, with an explicit stack of the leaves being visited and their next dependent to visit
+    constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::size_t> index(_leaves.size(), none);
+    std::vector<std::size_t> low(_leaves.size(), 0);
+    std::vector<bool> on_stack(_leaves.size(), false);
+    std::vector<std::size_t> stack;
+    std::vector<std::pair<std::size_t, std::size_t>> visits;
+    std::size_t counter{0};
+
+    auto discover = [&](std::size_t k)
+    {
+        index[k] = low[k] = counter++;
+        stack.push_back(k);
+        on_stack[k] = true;
+        visits.emplace_back(k, 0);
+    };
+
+    loops.clear();
+    for (std::size_t root = 0; root < _leaves.size(); root++)
+    {
+        if (index[root] != none)
+        {
+            continue;
+        }
+
+        discover(root);
+        while (!visits.empty())
+        {
+            const std::size_t k = visits.back().first;
+            const std::size_t n = visits.back().second++;
+            if (n < _dependents[k].size())
+            {
+                const std::size_t d = _dependents[k][n];
+                if (index[d] == none)
+                {
+                    discover(d);
+                }
+                else if (on_stack[d])
+                {
+                    low[k] = std::min(low[k], index[d]);
+                }
+                continue;
+            }
+
+            visits.pop_back();
+            if (!visits.empty())
+            {
+                low[visits.back().first] = std::min(low[visits.back().first], low[k]);
+            }
+
+            if (low[k] == index[k])
+            {
+                std::vector<std::size_t> component;
+                std::size_t m;
+                do
+                {
+                    m = stack.back();
+                    stack.pop_back();
+                    on_stack[m] = false;
+                    component.push_back(m);
+                } while (m != k);
+
+                if (component.size() > 1)
+                {
+                    std::sort(component.begin(), component.end());
+                    loops.emplace_back(std::move(component));
+                }
+            }
+        }
+    }
+}
+
+} // namespace pooya
@@ -0,0 +1,63 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_BLOCK_GRAPH_HPP__
+#define __POOYA_SOLVER_BLOCK_GRAPH_HPP__
+
+#include <cstddef>
+#include <vector>
+
+namespace pooya
+{
+
+class Block;
+class Leaf;
+
+// The dependency graph of the leaves of a model as implied by the signal link types. Leaf B depends on leaf A if A
+// outputs a signal that B requires (see Block::SignalLinkType::Required), i.e. B has a direct feedthrough from that
+// signal. Signals no leaf outputs, e.g. the ones assigned by the input callback, and the state variables are considered
+// to be available before any leaf is processed.
+class BlockGraph
+{
+public:
+    explicit BlockGraph(Block& model);
+
+    const std::vector<Leaf*>& leaves() const { return _leaves; }
+    const std::vector<std::size_t>& dependencies(std::size_t k) const { return _dependencies[k]; }
+    const std::vector<std::size_t>& dependents(std::size_t k) const { return _dependents[k]; }
+
+    // finds an order in which every leaf comes after the leaves it depends on
+    // returns false if there is a cycle of direct feedthroughs (an algebraic loop)
+    bool topological_order(std::vector<std::size_t>& order) const;
+
+    // the same for the graph condensed into num_nodes nodes, node[k] being the one of leaf k, e.g. with the leaves of
+    // an algebraic loop that is solved as one leaf in one node, the nodes in or after a cycle are left out
+    bool topological_order(const std::vector<std::size_t>& node, std::size_t num_nodes,
+                           std::vector<std::size_t>& order) const;
+
+    // finds the strongly connected components with more than one leaf, i.e. the algebraic loops
+    void algebraic_loops(std::vector<std::vector<std::size_t>>& loops) const;
+
+protected:
+    std::vector<Leaf*> _leaves;
+    std::vector<std::vector<std::size_t>> _dependencies;
+    std::vector<std::vector<std::size_t>> _dependents;
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_BLOCK_GRAPH_HPP__
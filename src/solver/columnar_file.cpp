@@ -0,0 +1,206 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+
+#include "columnar_file.hpp"
+#include "src/helper/trace.hpp"
+#include "src/helper/util.hpp"
+
+namespace pooya
+{
+
+namespace
+{
+
+constexpr char magic[8] = {'P', 'O', 'O', 'Y', 'A', 'C', 'O', 'L'};
+constexpr uint32_t version{1};
+constexpr uint32_t flag_time{1};
+
+std::size_t align(std::size_t size)
+{
+    return (size + ColumnarFile::alignment - 1) / ColumnarFile::alignment * ColumnarFile::alignment;
+}
+
+template<typename T>
+void put(std::string& header, const T& value)
+{
+    header.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// reads a value of the header and advances the position
+template<typename T>
+T get(const char* data, std::size_t size, std::size_t& pos, const std::string& filename)
+{
+    pooya_verify(pos + sizeof(T) <= size, filename + ": truncated header!");
+    T value;
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+} // namespace
+
+void ColumnarFile::write(const std::string& filename, const std::vector<Signal>& signals, const Array* time,
+                         const Eigen::Ref<const Eigen::MatrixXd>& values)
+{
+    pooya_trace("filename = " + filename);
+
+    // the signals are looked up by their names, so only the unnamed ones, which are looked up by index, may repeat
+    std::size_t ncols = 0;
+    std::unordered_set<std::string> names;
+    for (const auto& sig : signals)
+    {
+        ncols += sig._width;
+        pooya_verify(sig._name.empty() || names.insert(sig._name).second,
+                     filename + ": " + sig._name + ": the name of a signal is repeated!");
+    }
+    pooya_verify(static_cast<std::size_t>(values.cols()) == ncols, "the values do not match the signals!");
+    pooya_verify(!time || (time->size() == values.rows()), "the time does not match the values!");
+
+    const uint64_t nrows         = values.rows();
+    const uint64_t column_stride = align(nrows * sizeof(double));
+
+    std::string header(magic, sizeof(magic));
+    put(header, version);
+    put(header, time ? flag_time : uint32_t(0));
+    put(header, nrows);
+    put(header, uint64_t(signals.size()));
+    put(header, column_stride);
+    const std::size_t data_offset_pos = header.size();
+    put(header, uint64_t(0));
+    for (const auto& sig : signals)
+    {
+        put(header, static_cast<uint32_t>(sig._type));
+        put(header, sig._width);
+        put(header, uint64_t(sig._name.size()));
+        header += sig._name;
+    }
+    const uint64_t data_offset = align(header.size());
+    std::memcpy(header.data() + data_offset_pos, &data_offset, sizeof(data_offset));
+    header.resize(data_offset, '\0');
+
+    std::ofstream ofs(filename, std::ios::binary);
+    pooya_verify(ofs.is_open(), filename + ": cannot open the file!");
+    ofs.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    const std::string padding(column_stride - nrows * sizeof(double), '\0');
+    auto write_column = [&](const double* column)
+    {
+        ofs.write(reinterpret_cast<const char*>(column), static_cast<std::streamsize>(nrows * sizeof(double)));
+        ofs.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    };
+    if (time)
+    {
+        write_column(time->data());
+    }
+    for (Eigen::Index j = 0; j < values.cols(); j++)
+    {
+        write_column(values.col(j).data());
+    }
+    pooya_verify(ofs.good(), filename + ": cannot write to the file!");
+}
+
+ColumnarFile::Mapping::Mapping(const std::string& filename)
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    pooya_verify(fd >= 0, filename + ": cannot open the file!");
+    struct stat st;
+    const bool stat_ok = ::fstat(fd, &st) == 0;
+    if (stat_ok && (st.st_size > 0))
+    {
+        _size      = static_cast<std::size_t>(st.st_size);
+        void* data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        _data      = data == MAP_FAILED ? nullptr : static_cast<const char*>(data);
+    }
+    ::close(fd); // the mapping keeps the file open
+    pooya_verify(_data, filename + ": cannot map the file into memory!");
+}
+
+ColumnarFile::Mapping::~Mapping()
+{
+    if (_data)
+    {
+        ::munmap(const_cast<char*>(_data), _size);
+    }
+}
+
+ColumnarFile::ColumnarFile(const std::string& filename) : _filename(filename), _mapping(filename)
+{
+    pooya_trace("filename = " + filename);
+
+    const char* data       = _mapping.data();
+    const std::size_t size = _mapping.size();
+
+    std::size_t pos = sizeof(magic);
+    pooya_verify((size >= pos) && (std::memcmp(data, magic, sizeof(magic)) == 0), filename + ": not a columnar file!");
+    pooya_verify(get<uint32_t>(data, size, pos, filename) == version, filename + ": unsupported version!");
+    _has_time           = get<uint32_t>(data, size, pos, filename) & flag_time;
+    _nrows              = get<uint64_t>(data, size, pos, filename);
+    const auto nsignals = get<uint64_t>(data, size, pos, filename);
+    _column_stride      = get<uint64_t>(data, size, pos, filename);
+    _data_offset        = get<uint64_t>(data, size, pos, filename);
+
+    std::size_t offset = _data_offset + (_has_time ? _column_stride : 0);
+    for (uint64_t k = 0; k < nsignals; k++)
+    {
+        Signal sig;
+        sig._type            = static_cast<Type>(get<uint32_t>(data, size, pos, filename));
+        sig._width           = get<uint32_t>(data, size, pos, filename);
+        const auto name_size = get<uint64_t>(data, size, pos, filename);
+        pooya_verify(pos + name_size <= size, filename + ": truncated header!");
+        sig._name.assign(data + pos, name_size);
+        pos += name_size;
+
+        _offsets.push_back(offset);
+        offset += sig._width * _column_stride;
+        _signals.push_back(std::move(sig));
+    }
+    pooya_verify((_data_offset % alignment == 0) && (_column_stride >= _nrows * sizeof(double)) &&
+                     (_column_stride % sizeof(double) == 0) && (offset <= size),
+                 filename + ": corrupt file!");
+}
+
+ColumnarFile::ColumnMap ColumnarFile::time() const
+{
+    pooya_verify(_has_time, _filename + ": no time column!");
+    return ColumnMap(column(_data_offset), _nrows);
+}
+
+ColumnarFile::SignalMap ColumnarFile::operator[](const std::string& name) const
+{
+    pooya_verify(!name.empty(), _filename + ": an unnamed signal is looked up by its index!");
+    auto it = std::find_if(_signals.begin(), _signals.end(), [&](const Signal& sig) { return sig._name == name; });
+    pooya_verify(it != _signals.end(), _filename + ": " + name + ": no such signal!");
+    return signal(static_cast<std::size_t>(it - _signals.begin()));
+}
+
+ColumnarFile::SignalMap ColumnarFile::signal(std::size_t index) const
+{
+    pooya_verify(index < _signals.size(), _filename + ": " + std::to_string(index) + ": no such signal!");
+    return SignalMap(column(_offsets[index]), _nrows, _signals[index]._width,
+                     Eigen::OuterStride<>(static_cast<Eigen::Index>(_column_stride / sizeof(double))));
+}
+
+} // namespace pooya
@@ -0,0 +1,127 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_COLUMNAR_FILE_HPP__
+#define __POOYA_SOLVER_COLUMNAR_FILE_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "src/signal/array.hpp"
+
+namespace pooya
+{
+
+// A binary file of recorded signals, column by column, that is mapped into memory for reading, see
+// History::export_columnar(). The file is self-contained, all the integers and values are in the native byte order:
+//
+//   char magic[8]            "POOYACOL"
+//   uint32 version           1
+//   uint32 flags             bit 0: the time column is present
+//   uint64 nrows             the rows of every column
+//   uint64 nsignals
+//   uint64 column_stride     the bytes from the start of a column to the start of the next one, a multiple of 64
+//   uint64 data_offset       the offset of the first column from the start of the file, a multiple of 64
+//   nsignals times:
+//     uint32 type            see ColumnarFile::Type
+//     uint32 width           the columns of the signal, 1 for all but the arrays
+//     uint64 name_size
+//     char name[name_size]
+//   padding up to data_offset
+//   the time column if present and then the columns of the signals in order, column_stride bytes apart, each with
+//   nrows doubles
+//
+// The values of the integer and boolean signals are stored as doubles too, so each signal reads as an nrows x width
+// matrix without a copy.
+class ColumnarFile
+{
+public:
+    enum class Type : uint32_t
+    {
+        Scalar = 0,
+        Int    = 1,
+        Bool   = 2,
+        Array  = 3,
+    };
+
+    struct Signal
+    {
+        std::string _name;
+        Type _type;
+        uint32_t _width;
+    };
+
+    using ColumnMap = Eigen::Map<const Array>;
+    using SignalMap = Eigen::Map<const Eigen::MatrixXd, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+    static constexpr std::size_t alignment{64};
+
+    // writes the file, time may be nullptr, values has a column per scalar and per element of an array of the signals
+    // the names of the signals must be unique, except for the unnamed ones
+    static void write(const std::string& filename, const std::vector<Signal>& signals, const Array* time,
+                      const Eigen::Ref<const Eigen::MatrixXd>& values);
+
+    // maps the file into memory for reading
+    explicit ColumnarFile(const std::string& filename);
+    ColumnarFile(const ColumnarFile&) = delete; // no copy constructor
+
+    std::size_t nrows() const { return _nrows; }
+    bool has_time() const { return _has_time; }
+    const std::vector<Signal>& signals() const { return _signals; }
+
+    ColumnMap time() const;
+    SignalMap operator[](const std::string& name) const;
+    // the signal at index of signals(), e.g. an unnamed one
+    SignalMap signal(std::size_t index) const;
+
+protected:
+    // a read-only mapping of a file into memory, which is unmapped when it is destroyed, e.g. if the file is not valid
+    class Mapping
+    {
+    public:
+        explicit Mapping(const std::string& filename);
+        Mapping(const Mapping&) = delete; // no copy constructor
+        ~Mapping();
+
+        const char* data() const { return _data; }
+        std::size_t size() const { return _size; }
+
+    protected:
+        const char* _data{nullptr};
+        std::size_t _size{0};
+    };
+
+    std::string _filename;
+    Mapping _mapping;
+    std::size_t _nrows{0};
+    bool _has_time{false};
+    std::vector<Signal> _signals;
+    std::size_t _data_offset{0};
+    std::size_t _column_stride{0};
+    std::vector<std::size_t> _offsets; // of the first column of the signals
+
+    const double* column(std::size_t offset) const
+    {
+        return reinterpret_cast<const double*>(_mapping.data() + offset);
+    }
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_COLUMNAR_FILE_HPP__
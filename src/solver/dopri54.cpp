@@ -0,0 +1,81 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "dopri54.hpp"
+#include "src/helper/util.hpp"
+
+namespace pooya
+{
+
+void DoPri54::init(std::size_t num_states)
+{
+    _controller.init(num_states);
+    _K1.resize(num_states);
+    _K2.resize(num_states);
+    _K3.resize(num_states);
+    _K4.resize(num_states);
+    _K5.resize(num_states);
+    _K6.resize(num_states);
+    _K7.resize(num_states);
+    _V.resize(num_states);
+    _V0.resize(num_states);
+    _V1.resize(num_states);
+    _valid    = false;
+    _reusable = false;
+}
+
+bool DoPri54::reuse_first_stage(double t0, const Array& v0)
+{
+    if (!_fsal || !_reusable || (v0.size() != _V0.size()))
+    {
+        return false;
+    }
+
+    // the next step
+    if ((t0 == _t1) && (v0 == _V1).all())
+    {
+        _K1.swap(_K7);
+        return true;
+    }
+
+    // a rejected step being retried
+    return (t0 == _t0) && (v0 == _V0).all();
+}
+
+// source: Hairer, Norsett and Wanner, Solving Ordinary Differential Equations I, dense output of DOPRI5
+void DoPri54::dense_output(double t, Array& v) const
+{
+    pooya_trace0;
+    pooya_verify(_valid, "no step to interpolate!");
+
+    const double h      = _t1 - _t0;
+    const double theta  = h != 0 ? (t - _t0) / h : 1;
+    const double theta1 = 1 - theta;
+
+    pooya_verify((theta >= 0) && (theta <= 1), "t is outside the last step!");
+
+    // v = v0 + theta * (r2 + theta1 * (r3 + theta * (r4 + theta1 * r5)))
+    const auto r2 = _V1 - _V0;
+    const auto r3 = h * _K1 - r2;
+    const auto r4 = r2 - h * _K7 - r3;
+    const auto r5 = (h * -12715105075. / 11282082432) * _K1 + (h * 87487479700. / 32700410799) * _K3 -
+                    (h * 10690763975. / 1880347072) * _K4 + (h * 701980252875. / 199316789632) * _K5 -
+                    (h * 1453857185. / 822651844) * _K6 + (h * 69997945. / 29380423) * _K7;
+    v = _V0 + theta * (r2 + theta1 * (r3 + theta * (r4 + theta1 * r5)));
+}
+
+} // namespace pooya
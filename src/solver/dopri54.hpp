@@ -0,0 +1,137 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_DOPRI54_HPP__
+#define __POOYA_SOLVER_DOPRI54_HPP__
+
+#include "step_size_controller.hpp"
+#include "stepper.hpp"
+
+namespace pooya
+{
+
+// Dormand-Prince 5(4): the 5th order solution is propagated and the embedded 4th order one estimates the error.
+//
+// The last stage of a step is the derivative at the end of the step. It is reused as the first stage of the next step
+// (first same as last, FSAL) if that step starts at the same time and state, so an accepted step costs 6 evaluations.
+// Likewise, the first stage is kept when a rejected step is retried. The simulators call model_changed() when the end
+// of a step changes the derivatives, e.g. at the sample hits of discrete leaves or with a Memory, and the stage is then
+// evaluated again.
+class DoPri54 : public StepperT<DoPri54>
+{
+protected:
+    StepSizeController _controller;
+    bool _fsal;
+
+    Array _K1;
+    Array _K2;
+    Array _K3;
+    Array _K4;
+    Array _K5;
+    Array _K6;
+    Array _K7;
+    Array _V;  // the input of a stage
+    Array _V0; // the start of the last step
+    Array _V1; // the end of the last step
+    double _t0{0};
+    double _t1{0};
+    bool _valid{false};    // _K1 is the derivative at (_t0, _V0) and _K7 is the derivative at (_t1, _V1)
+    bool _reusable{false}; // _K1 and _K7 are still the derivatives of the model, see model_changed()
+
+    // moves the derivative at (t0, v0) to _K1 if it is known from the last step
+    bool reuse_first_stage(double t0, const Array& v0);
+
+public:
+    explicit DoPri54(double abs_tol = 1e-6, double rel_tol = 1e-3, bool fsal = true)
+        : _controller(5, abs_tol, rel_tol), _fsal(fsal)
+    {
+    }
+
+    StepSizeController& controller() { return _controller; }
+
+    bool adaptive() const override { return true; }
+    bool accepted(double /*h*/, double /*new_h*/) const override { return _controller.accepted(); }
+
+    void init(std::size_t num_states) override;
+
+    // the last step is still interpolated, but its stages are not reused
+    void model_changed() override { _reusable = false; }
+
+    // the first stage of the next step is evaluated again after loading
+    void serialize(Archive& ar) override
+    {
+        _controller.serialize(ar);
+        _valid    = _valid && !ar.loading();
+        _reusable = _reusable && !ar.loading();
+    }
+
+    template<typename Callback>
+    void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+    {
+        pooya_trace0;
+        double h = t1 - t0;
+
+        if (!reuse_first_stage(t0, v0))
+        {
+            _K1 = f(t0, v0);
+        }
+        _valid    = false;
+        _reusable = false;
+
+        _V  = v0 + (h / 5) * _K1;
+        _K2 = f(t0 + h / 5, _V);
+        _V  = v0 + (h * 3. / 40) * _K1 + (h * 9. / 40) * _K2;
+        _K3 = f(t0 + h * 3. / 10, _V);
+        _V  = v0 + (h * 44. / 45) * _K1 - (h * 56. / 15) * _K2 + (h * 32. / 9) * _K3;
+        _K4 = f(t0 + h * 4. / 5, _V);
+        _V  = v0 + (h * 19372. / 6561) * _K1 - (h * 25360. / 2187) * _K2 + (h * 64448. / 6561) * _K3 -
+             (h * 212. / 729) * _K4;
+        _K5 = f(t0 + h * 8. / 9, _V);
+        _V  = v0 + (h * 9017. / 3168) * _K1 - (h * 355. / 33) * _K2 + (h * 46732. / 5247) * _K3 +
+             (h * 49. / 176) * _K4 - (h * 5103. / 18656) * _K5;
+        _K6 = f(t1, _V);
+
+        v1 = v0 + (h * 35. / 384) * _K1 + (h * 500. / 1113) * _K3 + (h * 125. / 192) * _K4 -
+             (h * 2187. / 6784) * _K5 + (h * 11. / 84) * _K6;
+        _K7 = f(t1, v1);
+
+        _V0       = v0;
+        _V1       = v1;
+        _t0       = t0;
+        _t1       = t1;
+        _valid    = true;
+        _reusable = true;
+
+        // the difference of the 5th and 4th order solutions
+        _V = (h * 71. / 57600) * _K1 - (h * 71. / 16695) * _K3 + (h * 71. / 1920) * _K4 -
+             (h * 17253. / 339200) * _K5 + (h * 22. / 525) * _K6 - (h / 40) * _K7;
+        new_h = _controller.next_step(h, _controller.error_norm(_V, v0, v1));
+    }
+
+    // the 4th order interpolant of the last step, t must be within that step
+    void dense_output(double t, Array& v) const;
+
+    bool interpolate(double t, Array& v) const override
+    {
+        dense_output(t, v);
+        return true;
+    }
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_DOPRI54_HPP__
@@ -0,0 +1,176 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "ensemble_runner.hpp"
+#include "src/helper/trace.hpp"
+#include "src/helper/util.hpp"
+#include "src/signal/array_signal.hpp"
+#include "thread_pool.hpp"
+
+namespace pooya
+{
+
+EnsembleRunner::EnsembleRunner(ModelFactory model_factory, ParameterSampler parameter_sampler,
+                               HistorySpec history_spec, std::size_t num_threads)
+    : _model_factory(std::move(model_factory)), _parameter_sampler(std::move(parameter_sampler)),
+      _history_spec(std::move(history_spec)), _num_threads(std::max<std::size_t>(num_threads, 1))
+{
+    pooya_verify(_model_factory, "a model factory is required!");
+    pooya_verify(_history_spec, "a history spec is required!");
+}
+
+void EnsembleRunner::run(std::size_t num_samples, double t0, double t1, double dt)
+{
+    pooya_trace("num_samples: " + std::to_string(num_samples));
+    pooya_verify((dt > 0) && (t1 >= t0), "invalid time span!");
+
+    const auto num_times = static_cast<std::size_t>(std::floor((t1 - t0) / dt + 1e-9)) + 1;
+    _time                = Array::LinSpaced(num_times, t0, t0 + (num_times - 1) * dt);
+
+    _parameters.resize(num_samples);
+    for (std::size_t k = 0; k < num_samples; k++)
+    {
+        _parameters[k] = _parameter_sampler ? _parameter_sampler(k) : Parameters();
+    }
+
+    _names.clear();
+    _values.clear();
+    _idle.clear();
+    _layout_ready = false;
+
+    // a thread releases its instance after every chunk, so there are at most as many instances as threads, the one of a
+    // sample that throws is dropped as its state is unknown
+    ThreadPool thread_pool(std::min(_num_threads, std::max<std::size_t>(num_samples, 1)));
+    thread_pool.parallel_for(num_samples, 1,
+                             [&](std::size_t begin, std::size_t end)
+                             {
+                                 auto worker = acquire(t0);
+                                 for (auto k = begin; k < end; k++) run_sample(*worker, k, t0, dt);
+                                 release(std::move(worker));
+                             });
+    _idle.clear();
+}
+
+auto EnsembleRunner::acquire(double t0) -> std::unique_ptr<Worker>
+{
+    pooya_trace("t0: " + std::to_string(t0));
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_idle.empty())
+        {
+            auto worker = std::move(_idle.back());
+            _idle.pop_back();
+            return worker;
+        }
+    }
+
+    auto worker       = std::make_unique<Worker>();
+    worker->_instance = _model_factory();
+    pooya_verify(worker->_instance, "the model factory failed to build an instance!");
+
+    auto& sim = worker->_instance->simulator();
+    sim.init(t0);
+    worker->_initial = sim.save_checkpoint();
+    return worker;
+}
+
+void EnsembleRunner::release(std::unique_ptr<Worker> worker)
+{
+    pooya_trace0;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _idle.push_back(std::move(worker));
+}
+
+void EnsembleRunner::run_sample(Worker& worker, std::size_t sample, double t0, double dt)
+{
+    pooya_trace("sample: " + std::to_string(sample));
+
+    auto& instance = *worker._instance;
+    auto& sim      = instance.simulator();
+    sim.load_checkpoint(worker._initial);
+    instance.reset(_parameters[sample]);
+    sim.parameters_changed();
+
+    History history(static_cast<uint>(_time.size()));
+    _history_spec(instance, history);
+
+    for (uint k = 0; k < _time.size(); k++)
+    {
+        // the same expression as the one used for building the time vector, so the steps match across samples
+        double t = t0 + k * dt;
+        sim.run(t);
+        history.update(k, t);
+    }
+
+    merge(sample, history);
+}
+
+void EnsembleRunner::merge(std::size_t sample, const History& history)
+{
+    pooya_trace("sample: " + std::to_string(sample));
+
+    const auto& recorded = history.values();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_layout_ready)
+        {
+            for (const auto& sig : history.signals())
+            {
+                const auto& name = sig->name().str();
+#ifdef POOYA_ARRAY_SIGNAL
+                if (auto* pa = dynamic_cast<ArraySignalImpl*>(sig.get()); pa)
+                {
+                    for (std::size_t c = 0; c < pa->size(); c++)
+                    {
+                        _names.push_back(name + "[" + std::to_string(c) + "]");
+                    }
+                }
+                else
+#endif // POOYA_ARRAY_SIGNAL
+                {
+                    _names.push_back(name);
+                }
+            }
+            _values.assign(_names.size(), Eigen::MatrixXd(_time.size(), _parameters.size()));
+            _layout_ready = true;
+        }
+    }
+
+    // every sample owns its column, so the samples are merged without locking
+    pooya_verify(static_cast<std::size_t>(recorded.cols()) == _values.size(), "the samples track different signals!");
+    for (Eigen::Index c = 0; c < recorded.cols(); c++)
+    {
+        _values[c].col(sample) = recorded.col(c).head(_time.size());
+    }
+}
+
+const Eigen::MatrixXd& EnsembleRunner::operator[](const std::string& name) const
+{
+    pooya_trace("name: " + name);
+
+    auto it = std::find(_names.begin(), _names.end(), name);
+    pooya_verify(it != _names.end(), name + ": no such column!");
+    return _values[it - _names.begin()];
+}
+
+} // namespace pooya
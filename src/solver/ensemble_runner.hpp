@@ -0,0 +1,111 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_ENSEMBLE_RUNNER_HPP__
+#define __POOYA_SOLVER_ENSEMBLE_RUNNER_HPP__
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "history.hpp"
+#include "simulator_base.hpp"
+#include "src/signal/array.hpp"
+
+namespace pooya
+{
+
+// Runs many independent simulations of a model, e.g. a Monte Carlo study, on a pool of threads.
+//
+// The model factory builds at most one instance (the model with its stepper and simulator) per thread, which is
+// initialized at t0 by the runner and then runs the samples the thread takes one after another. Before each sample, the
+// instance is restored to its state right after the initialization from a checkpoint and given the parameters of the
+// sample, see Instance::reset(), so a sample does not depend on the ones the instance ran before it. An instance is
+// only used by one thread at a time, so the blocks do not need to be thread-safe. The history spec selects the signals
+// to record, and the recorded values of all the samples are merged into one column per recorded signal element.
+class EnsembleRunner
+{
+public:
+    using Parameters = Array;
+
+    class Instance
+    {
+    public:
+        virtual ~Instance()                = default;
+        virtual SimulatorBase& simulator() = 0;
+
+        // sets the parameters of a sample, e.g. the gains and the initial values of the integrators, the model is in
+        // its state at t0 when it is called
+        virtual void reset(const Parameters& params) = 0;
+    };
+
+    using ModelFactory     = std::function<std::unique_ptr<Instance>()>;
+    using ParameterSampler = std::function<Parameters(std::size_t sample)>;
+    using HistorySpec      = std::function<void(Instance& instance, History& history)>;
+
+    EnsembleRunner(ModelFactory model_factory, ParameterSampler parameter_sampler, HistorySpec history_spec,
+                   std::size_t num_threads = std::thread::hardware_concurrency());
+
+    // simulates num_samples samples from t0 to t1 and records the tracked signals every dt
+    // the parameters are sampled on the calling thread in the order of the samples, so the results do not depend on
+    // the number of threads, an exception thrown by a sample is rethrown on the calling thread
+    void run(std::size_t num_samples, double t0, double t1, double dt);
+
+    std::size_t num_samples() const { return _parameters.size(); }
+    const Array& time() const { return _time; }
+    const std::vector<Parameters>& parameters() const { return _parameters; }
+
+    // the recorded columns, e.g. "x" for a scalar signal and "v[0]", "v[1]", ... for an array signal
+    const std::vector<std::string>& names() const { return _names; }
+
+    // the values of a recorded column, one row per time point and one column per sample
+    const Eigen::MatrixXd& operator[](std::size_t column) const { return _values[column]; }
+    const Eigen::MatrixXd& operator[](const std::string& name) const;
+
+protected:
+    struct Worker
+    {
+        std::unique_ptr<Instance> _instance;
+        Archive::Blob _initial; // the state of the instance right after its initialization
+    };
+
+    ModelFactory _model_factory;
+    ParameterSampler _parameter_sampler;
+    HistorySpec _history_spec;
+    std::size_t _num_threads;
+
+    Array _time;
+    std::vector<Parameters> _parameters;
+    std::vector<std::string> _names;
+    std::vector<Eigen::MatrixXd> _values;
+    std::vector<std::unique_ptr<Worker>> _idle; // the instances no thread is using
+    std::mutex _mutex;
+    bool _layout_ready{false};
+
+    // takes an idle instance or builds a new one if there is none
+    std::unique_ptr<Worker> acquire(double t0);
+    void release(std::unique_ptr<Worker> worker);
+    void run_sample(Worker& worker, std::size_t sample, double t0, double dt);
+    void merge(std::size_t sample, const History& history);
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_ENSEMBLE_RUNNER_HPP__
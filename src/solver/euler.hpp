@@ -18,17 +18,24 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_SOLVER_EULER_HPP__
 #define __POOYA_SOLVER_EULER_HPP__
 
-#include "stepper_base.hpp"
+#include "stepper.hpp"
 
 namespace pooya
 {
 
-class Euler : public StepperBase
+class Euler : public StepperT<Euler>
 {
 public:
     Euler() = default;
 
-    void step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h) override;
+    template<typename Callback>
+    void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+    {
+        pooya_trace0;
+        double h = new_h = t1 - t0;
+
+        v1 = v0 + h * f(t0, v0);
+    }
 };
 
 } // namespace pooya
@@ -15,6 +15,9 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER I
 OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "fast_simulator.hpp"
 #include "src/block/leaf.hpp"
 #include "src/helper/util.hpp"
@@ -32,14 +35,53 @@ void FastSimulator::process_model(double t, bool call_pre_step, bool call_post_s
     }
     _model.input_cb(t);
 
+    update_rate_groups(t, call_post_step);
+
     if (call_pre_step) _model.pre_step(t);
 
+    if (_constant_group && _constant_group->_active)
+    {
+        _constant_tape.run(t, 0, _constant_tape.size());
+    }
+
+    // the consecutive levels that are processed on the calling thread are run as one stretch of the tape
+    std::size_t begin = 0;
+    std::size_t end   = 0;
     for (auto& list : _processing_order)
-        for (auto* leaf : list) leaf->activation_function(t);
+    {
+        if (_thread_pool && (list.size() >= 2 * _min_chunk_size))
+        {
+            _tape.run(t, begin, end);
+            process_level(end, list.size(), t);
+            begin = end + list.size();
+        }
+        end += list.size();
+    }
+    _tape.run(t, begin, end);
 
     if (call_post_step) _model.post_step(t);
 }
 
+void FastSimulator::process_level(std::size_t begin, std::size_t size, double t)
+{
+    // a few chunks per thread leave room for balancing the load among the threads
+    std::size_t chunk_size = std::max(_min_chunk_size, size / (4 * _thread_pool->num_threads()) + 1);
+
+    _thread_pool->parallel_for(size, chunk_size,
+                               [&](std::size_t b, std::size_t e) { _tape.run(t, begin + b, begin + e); });
+}
+
+void FastSimulator::add_instruction(Tape& tape, Leaf& leaf, bool call)
+{
+    const auto size = tape.size();
+    if (call || !leaf.lower(tape))
+    {
+        tape.add_call(leaf);
+    }
+    pooya_verify(tape.size() == size + 1,
+                 leaf.full_name().str() + ": a leaf must be lowered to exactly one instruction!");
+}
+
 void FastSimulator::init(double t0)
 {
     pooya_trace("t0: " + std::to_string(t0));
@@ -58,7 +100,6 @@ void FastSimulator::init(double t0)
 
     std::vector<Leaf*> po;
     po.reserve(num_blocks);
-    _processing_order.reserve(num_blocks);
 
     auto add_blocks_cb = [&po](Block& c, uint32_t /*level*/) -> bool
     {
@@ -67,6 +108,21 @@ void FastSimulator::init(double t0)
     };
     _model.visit(add_blocks_cb, 0);
 
+    // the leaves of an algebraic loop are processed by the loop
+    std::unordered_set<const Leaf*> in_loops;
+    for (auto& loop : _algebraic_loops)
+    {
+        in_loops.insert(loop->leaves().begin(), loop->leaves().end());
+    }
+    po.erase(std::remove_if(po.begin(), po.end(), [&](const Leaf* leaf) { return in_loops.count(leaf) > 0; }),
+             po.end());
+    for (auto& loop : _algebraic_loops)
+    {
+        po.push_back(loop.get());
+    }
+    num_blocks = static_cast<uint>(po.size());
+    _processing_order.reserve(num_blocks);
+
     if (_inputs_cb)
     {
         _inputs_cb(_model, t0);
@@ -74,47 +130,70 @@ void FastSimulator::init(double t0)
     _model.input_cb(t0);
     _model.pre_step(t0);
 
+    // a level is the leaves that are ready before any of them is processed, so none of them depends on another
     uint num_blocks_added = 0;
     for (;;)
     {
-        uint num_blocks_to_add = 0;
+        std::vector<Leaf*> list;
         for (auto* leaf : po)
         {
-            if (!leaf->processed() && leaf->ready_to_process()) ++num_blocks_to_add;
+            if (!leaf->processed() && leaf->ready_to_process()) list.push_back(leaf);
         }
 
-        if (num_blocks_to_add == 0) break;
+        if (list.empty()) break;
 
-        auto& list = _processing_order.emplace_back();
-        list.reserve(num_blocks_to_add);
-
-        for (auto* leaf : po)
+        bool all_processed = true;
+        for (auto* leaf : list)
         {
-            if (list.size() == num_blocks_to_add) break;
-
-            if (leaf->processed() || !leaf->ready_to_process()) continue;
-
             leaf->process(t0, false);
-
-            if (leaf->processed())
-                list.push_back(leaf);
-            else
-                break;
+            all_processed = all_processed && leaf->processed();
         }
 
-        if (list.size() != num_blocks_to_add) break;
-
-        list.shrink_to_fit();
+        if (!all_processed) break;
 
-        num_blocks_added += num_blocks_to_add;
+        num_blocks_added += static_cast<uint>(list.size());
+        _processing_order.emplace_back(std::move(list));
     }
 
     pooya_verify(num_blocks_added == num_blocks,
                  "The FastSimulator does not seem the right choice for the given model. Try Simulator instead.");
 
+    // the constant leaves only depend on each other, so they are taken out of the levels and evaluated before them,
+    // once and again after the parameters are changed
+    _tape.reset(_arena.data(), _arena.size());
+    _constant_tape.reset(_arena.data(), _arena.size());
+    for (auto& list : _processing_order)
+    {
+        auto is_constant = [&](const Leaf* leaf) -> bool
+        {
+            const auto* group = rate_group(*leaf);
+            return group && group->_sample_time.is_constant();
+        };
+        for (auto* leaf : list)
+        {
+            if (is_constant(leaf))
+            {
+                _constant_group = rate_group(*leaf);
+                add_instruction(_constant_tape, *leaf, false);
+            }
+        }
+        list.erase(std::remove_if(list.begin(), list.end(), is_constant), list.end());
+    }
+    _processing_order.erase(std::remove_if(_processing_order.begin(), _processing_order.end(),
+                                           [](const std::vector<Leaf*>& list) { return list.empty(); }),
+                            _processing_order.end());
     _processing_order.shrink_to_fit();
 
-    for (auto& sig : value_signals_) sig->clear();
+    // compile the processing order, a held leaf is skipped, which only a call does
+    for (auto& list : _processing_order)
+    {
+        for (auto* leaf : list)
+        {
+            add_instruction(_tape, *leaf, rate_group(*leaf) != nullptr);
+        }
+    }
+
+    clear_signals();
 
     process_model(t0, true, true);
 }
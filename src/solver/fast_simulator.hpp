@@ -18,7 +18,13 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_SOLVER_FAST_SIMULATOR_HPP__
 #define __POOYA_SOLVER_FAST_SIMULATOR_HPP__
 
+#include <memory>
+
 #include "simulator_base.hpp"
+#include "src/block/tape.hpp"
+#include "src/helper/util.hpp"
+#include "src/helper/verify.hpp"
+#include "thread_pool.hpp"
 
 namespace pooya
 {
@@ -28,9 +34,12 @@ class Leaf;
 class FastSimulator : public SimulatorBase
 {
 public:
+    // with num_threads > 1, the leaves of each level of the processing order are activated in parallel, which requires
+    // the activation functions of the leaves of a level to be safe to call concurrently
     explicit FastSimulator(Block& model, SimulatorBase::InputCallback inputs_cb = nullptr,
-                           StepperBase* stepper = nullptr)
-        : SimulatorBase(model, inputs_cb, stepper)
+                           StepperBase* stepper = nullptr, std::size_t num_threads = 1)
+        : SimulatorBase(model, inputs_cb, stepper),
+          _thread_pool(num_threads > 1 ? std::make_unique<ThreadPool>(num_threads) : nullptr)
     {
     }
     FastSimulator(const FastSimulator&) = delete; // no copy constructor
@@ -38,8 +47,26 @@ public:
 
     void init(double t0 = 0.0) override;
 
+    // the estimated cost of activating a leaf is the unit of the cost, so a level is processed on the calling thread
+    // unless it has at least two chunks of this many leaves
+    void set_min_chunk_size(std::size_t min_chunk_size)
+    {
+        pooya_verify(min_chunk_size > 0, "the chunk size must be positive!");
+        _min_chunk_size = min_chunk_size;
+    }
+
 protected:
-    std::vector<std::vector<Leaf*>> _processing_order;
+    std::vector<std::vector<Leaf*>> _processing_order; // the leaves that are processed in every evaluation
+    Tape _tape;                                         // one instruction per leaf, in the processing order
+    Tape _constant_tape;                                // the constant leaves, run when their rate group is activated
+    const RateGroup* _constant_group{nullptr};
+    std::unique_ptr<ThreadPool> _thread_pool;
+    std::size_t _min_chunk_size{32};
+
+    void process_level(std::size_t begin, std::size_t size, double t);
+
+    // lowers the leaf to one instruction of the tape, or adds a call to it if call is true or it cannot be lowered
+    void add_instruction(Tape& tape, Leaf& leaf, bool call);
 
     void process_model(double t, bool call_pre_step, bool call_post_step) override;
 };
@@ -15,192 +15,327 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER I
 OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-#include <fstream>
+#include <algorithm>
+#include <exception>
 #include <memory>
 #include <string>
 
+#include "columnar_file.hpp"
 #include "history.hpp"
 #include "src/block/block.hpp"
 
 namespace pooya
 {
 
+namespace
+{
+
+template<typename T>
+void copy_value(const ValueSignalImpl& sig, double* dst, Eigen::Index /*stride*/)
+{
+    *dst = static_cast<double>(static_cast<const typename Types<T>::SignalImpl&>(sig).get_value());
+}
+
+#ifdef POOYA_ARRAY_SIGNAL
+void copy_array(const ValueSignalImpl& sig, double* dst, Eigen::Index stride)
+{
+    const auto& value = static_cast<const ArraySignalImpl&>(sig).get_value();
+    for (Eigen::Index j = 0; j < value.size(); j++)
+    {
+        dst[j * stride] = value[j];
+    }
+}
+#endif // POOYA_ARRAY_SIGNAL
+
+} // namespace
+
 bool History::track(const Signal& sig)
 {
-    pooya_debug_verify(empty(), "track should be called before the history is updated!");
+    pooya_debug_verify(_chunks.empty(), "track should be called before the history is updated!");
 
     auto vsig = std::dynamic_pointer_cast<ValueSignalImpl>(sig->shared_from_this());
     if (!vsig || std::find(_signals.begin(), _signals.end(), vsig) != _signals.end()) return false;
 
+    Column column{vsig.get(), _ncols, 1, nullptr};
+    if (dynamic_cast<ScalarSignalImpl*>(vsig.get()))
+    {
+        column._copy = copy_value<double>;
+    }
+#ifdef POOYA_INT_SIGNAL
+    else if (dynamic_cast<IntSignalImpl*>(vsig.get()))
+    {
+        column._copy = copy_value<int>;
+    }
+#endif // POOYA_INT_SIGNAL
+#ifdef POOYA_BOOL_SIGNAL
+    else if (dynamic_cast<BoolSignalImpl*>(vsig.get()))
+    {
+        column._copy = copy_value<bool>;
+    }
+#endif // POOYA_BOOL_SIGNAL
+#ifdef POOYA_ARRAY_SIGNAL
+    else if (auto* pa = dynamic_cast<ArraySignalImpl*>(vsig.get()); pa)
+    {
+        column._width = static_cast<Eigen::Index>(pa->size());
+        column._copy  = copy_array;
+    }
+#endif // POOYA_ARRAY_SIGNAL
+    else
+    {
+        return false;
+    }
+
+    _ncols += column._width;
+    _columns.push_back(column);
     _signals.emplace_back(std::move(vsig));
     return true;
 }
 
 void History::untrack(const Signal& sig)
 {
-    pooya_debug_verify(empty(), "untrack should be called before the history is updated!");
+    pooya_debug_verify(_chunks.empty(), "untrack should be called before the history is updated!");
 
     auto vsig = std::dynamic_pointer_cast<ValueSignalImpl>(sig->shared_from_this());
-    if (vsig) _signals.erase(std::find(_signals.begin(), _signals.end(), vsig));
+    auto it   = std::find(_signals.begin(), _signals.end(), vsig);
+    if (!vsig || (it == _signals.end())) return;
+
+    // the columns of the signals tracked after it move to the left
+    const std::size_t index = it - _signals.begin();
+    const auto width        = _columns[index]._width;
+    for (std::size_t k = index + 1; k < _columns.size(); k++)
+    {
+        _columns[k]._col -= width;
+    }
+    _ncols -= width;
+    _columns.erase(_columns.begin() + index);
+    _signals.erase(it);
 }
 
 void History::update(uint k, double t)
 {
     pooya_trace("k = " + std::to_string(k));
-    if (empty())
+    if (_signals.empty())
     {
-        if (_signals.empty())
+        return;
+    }
+
+    // appending a chunk leaves the existing ones in place, when streaming the chunk in memory is written instead
+    const std::size_t index = k / _nrows_grow;
+    if (_writer)
+    {
+        pooya_verify(index >= _first_chunk, "the rows that are streamed to the sink cannot be updated!");
+        // a chunk that is skipped would be written with the rows of the one before it
+        pooya_verify(index <= _first_chunk + 1, "the rows that are streamed to the sink should be updated in order!");
+        if (index > _first_chunk)
         {
-            return;
+            _writer->write(_chunks.front(), _nrows_grow);
+            _first_chunk = index;
         }
-        for (auto& sig : _signals)
+    }
+    while (_chunks.size() <= index - _first_chunk)
+    {
+        _chunks.emplace_back(_nrows_grow, _ncols + 1);
+    }
+    auto& chunk = _chunks[index - _first_chunk];
+    if (chunk.rows() < _nrows_grow)
+    {
+        chunk.conservativeResize(_nrows_grow, Eigen::NoChange); // trimmed by shrink_to_fit()
+    }
+
+    const Eigen::Index stride = chunk.rows();
+    double* row               = chunk.data() + (k % _nrows_grow);
+    row[0]                    = t;
+    for (const auto& column : _columns)
+    {
+        double* dst = row + (column._col + 1) * stride;
+        if (column._sig->assigned())
         {
-            if (dynamic_cast<ScalarSignalImpl*>(sig.get())
-#ifdef POOYA_INT_SIGNAL
-                || dynamic_cast<IntSignalImpl*>(sig.get())
-#endif // POOYA_INT_SIGNAL
-#ifdef POOYA_BOOL_SIGNAL
-                || dynamic_cast<BoolSignalImpl*>(sig.get())
-#endif // POOYA_BOOL_SIGNAL
-            )
-            {
-                insert_or_assign(sig, Array(_nrows_grow));
-            }
-#ifdef POOYA_ARRAY_SIGNAL
-            else if (auto* pa = dynamic_cast<ArraySignalImpl*>(sig.get()); pa)
+            column._copy(*column._sig, dst, stride);
+        }
+        else
+        {
+            for (Eigen::Index j = 0; j < column._width; j++)
             {
-                insert_or_assign(sig, Eigen::MatrixXd(_nrows_grow, pa->size()));
+                dst[j * stride] = 0;
             }
-#endif // POOYA_ARRAY_SIGNAL
         }
     }
 
-    if (k >= _time.rows())
+    if ((_bottom_row == uint(-1)) || (k > _bottom_row))
     {
-        _time.conservativeResize(k + _nrows_grow, Eigen::NoChange);
+        _bottom_row = k;
     }
-    _time(k, 0) = t;
-    for (auto& sig : _signals)
+    _assembled = false;
+}
+
+History::~History()
+{
+    try
+    {
+        close_sink();
+    }
+    catch (const std::exception& e)
+    {
+        helper::pooya_show_warning(__FILE__, __LINE__, std::string("history: ") + e.what());
+    }
+}
+
+void History::stream_to(HistorySink& sink)
+{
+    pooya_trace0;
+    pooya_verify(_chunks.empty() && !_streamed, "stream_to should be called before the history is updated!");
+
+    _writer   = std::make_unique<HistoryWriter>(sink, column_names(), _nrows_grow, _ncols + 1);
+    _streamed = true;
+    _chunks.emplace_back(_nrows_grow, _ncols + 1);
+}
+
+void History::close_sink()
+{
+    pooya_trace0;
+    if (!_writer)
+    {
+        return;
+    }
+
+    auto writer             = std::move(_writer);
+    auto chunk              = std::move(_chunks.front());
+    const Eigen::Index rows = static_cast<Eigen::Index>(nrows() - _first_chunk * _nrows_grow);
+
+    // the history is empty again, as if it was never streamed
+    _chunks.clear();
+    _bottom_row  = static_cast<uint>(-1);
+    _first_chunk = 0;
+    _streamed    = false;
+    _assembled   = false;
+
+    if (rows > 0)
+    {
+        writer->write(chunk, rows);
+    }
+    writer->close();
+}
+
+std::vector<std::string> History::column_names() const
+{
+    std::vector<std::string> names{"time"};
+    for (const auto& column : _columns)
     {
-        auto& h = at(sig);
-        if (k >= h.rows())
-        {
-            h.conservativeResize(k + _nrows_grow, Eigen::NoChange);
-        }
-        bool valid = sig->assigned();
-        if (auto* ps = dynamic_cast<ScalarSignalImpl*>(sig.get()); ps)
-        {
-            h(k, 0) = valid ? ps->get_value() : 0;
-        }
-#ifdef POOYA_INT_SIGNAL
-        else if (auto* pi = dynamic_cast<IntSignalImpl*>(sig.get()); pi)
-        {
-            h(k, 0) = valid ? pi->get_value() : 0;
-        }
-#endif // POOYA_INT_SIGNAL
-#ifdef POOYA_BOOL_SIGNAL
-        else if (auto* pb = dynamic_cast<BoolSignalImpl*>(sig.get()); pb)
-        {
-            h(k, 0) = valid ? pb->get_value() : 0;
-        }
-#endif // POOYA_BOOL_SIGNAL
 #ifdef POOYA_ARRAY_SIGNAL
-        else if (auto* pa = dynamic_cast<ArraySignalImpl*>(sig.get()); pa)
+        if (dynamic_cast<const ArraySignalImpl*>(column._sig))
         {
-            if (valid)
-            {
-                h.row(k) = pa->get_value();
-            }
-            else
+            for (Eigen::Index k = 0; k < column._width; k++)
             {
-                h.row(k).setZero();
+                names.push_back(column._sig->name().str() + "[" + std::to_string(k) + "]");
             }
         }
+        else
 #endif // POOYA_ARRAY_SIGNAL
+        {
+            names.push_back(column._sig->name().str());
+        }
     }
+    return names;
+}
 
-    if ((_bottom_row == uint(-1)) || (k > _bottom_row))
+void History::assemble() const
+{
+    pooya_verify(!_streamed, "the rows of the history are streamed to a sink!");
+    if (_assembled)
     {
-        _bottom_row = k;
+        return;
     }
+
+    const Eigen::Index nrows = static_cast<Eigen::Index>(this->nrows());
+    _time.resize(nrows);
+    _values.resize(nrows, _ncols);
+    for (std::size_t c = 0; c < _chunks.size(); c++)
+    {
+        const auto& chunk        = _chunks[c];
+        const Eigen::Index first = static_cast<Eigen::Index>(c) * _nrows_grow;
+        const Eigen::Index n     = std::min<Eigen::Index>(chunk.rows(), nrows - first);
+        if (n > 0)
+        {
+            _time.segment(first, n)      = chunk.col(0).head(n);
+            _values.middleRows(first, n) = chunk.block(0, 1, n, _ncols);
+        }
+    }
+    _assembled = true;
+}
+
+History::Values History::operator[](const Signal& sig) const
+{
+    auto it = std::find(_signals.begin(), _signals.end(), sig->shared_from_this());
+    pooya_verify(it != _signals.end(), sig->name().str() + ": not tracked!");
+    const auto& column = _columns[it - _signals.begin()];
+    return values().middleCols(column._col, column._width);
 }
 
 void History::shrink_to_fit()
 {
     pooya_trace0;
-    const uint nrows = _bottom_row + 1;
-
-    if (nrows >= _time.rows())
+    if (_streamed)
     {
         return;
-    } // practically, nrows can't be the greater
+    }
 
-    _time.conservativeResize(nrows, Eigen::NoChange);
-    for (auto& p : *this)
+    // only the last chunk can have unused rows
+    const std::size_t nchunks = (nrows() + _nrows_grow - 1) / _nrows_grow;
+    _chunks.resize(nchunks);
+    if (nchunks > 0)
     {
-        p.second.conservativeResize(nrows, Eigen::NoChange);
+        _chunks.back().conservativeResize(nrows() - (nchunks - 1) * _nrows_grow, Eigen::NoChange);
     }
 }
 
-void History::export_csv(const std::string& filename)
+void History::export_csv(const std::string& filename, std::size_t num_threads)
 {
     pooya_trace("filename = " + filename);
-    if (size() == 0)
+    pooya_verify(!_streamed, "the rows of the history are streamed to a sink!");
+    if (_chunks.empty())
     {
         return;
     }
 
-    std::ofstream ofs(filename);
-
-    // header
-    ofs << "time";
-    for (const auto& h : *this)
+    // the chunks are already rows of the time and the values
+    CsvHistorySink sink(filename, num_threads);
+    sink.open(column_names());
+    const Eigen::Index nrows = static_cast<Eigen::Index>(this->nrows());
+    for (std::size_t c = 0; c < _chunks.size(); c++)
     {
-        if (h.first)
+        const auto& chunk        = _chunks[c];
+        const Eigen::Index first = static_cast<Eigen::Index>(c) * _nrows_grow;
+        const Eigen::Index n     = std::min<Eigen::Index>(chunk.rows(), nrows - first);
+        if (n > 0)
         {
-#ifdef POOYA_ARRAY_SIGNAL
-            if (auto* pa = dynamic_cast<ArraySignalImpl*>(h.first.get()); pa)
-            {
-                for (std::size_t k = 0; k < pa->size(); k++)
-                {
-                    ofs << "," << h.first->name().str() << "[" << k << "]";
-                }
-            }
-            else
-#endif // POOYA_ARRAY_SIGNAL
-            {
-                ofs << "," << h.first->name().str();
-            }
+            sink.write(chunk.topRows(n));
         }
     }
-    ofs << "\n";
+    sink.close();
+}
 
-    // values
-    auto n = time().size();
-    for (int k = 0; k < n; k++)
+void History::export_columnar(const std::string& filename, bool with_time)
+{
+    pooya_trace("filename = " + filename);
+
+    std::vector<ColumnarFile::Signal> signals;
+    signals.reserve(_columns.size());
+    for (const auto& column : _columns)
     {
-        ofs << time()(k);
-        for (const auto& h : *this)
-        {
-            if (h.first)
-            {
+        auto type = ColumnarFile::Type::Scalar;
+#ifdef POOYA_INT_SIGNAL
+        if (dynamic_cast<const IntSignalImpl*>(column._sig)) type = ColumnarFile::Type::Int;
+#endif // POOYA_INT_SIGNAL
+#ifdef POOYA_BOOL_SIGNAL
+        if (dynamic_cast<const BoolSignalImpl*>(column._sig)) type = ColumnarFile::Type::Bool;
+#endif // POOYA_BOOL_SIGNAL
 #ifdef POOYA_ARRAY_SIGNAL
-                if (auto* pa = dynamic_cast<ArraySignalImpl*>(h.first.get()); pa)
-                {
-                    for (std::size_t j = 0; j < pa->size(); j++)
-                    {
-                        ofs << "," << h.second(k, j);
-                    }
-                }
-                else
+        if (dynamic_cast<const ArraySignalImpl*>(column._sig)) type = ColumnarFile::Type::Array;
 #endif // POOYA_ARRAY_SIGNAL
-                {
-                    ofs << "," << h.second(k);
-                }
-            }
-        }
-        ofs << "\n";
+        signals.push_back({column._sig->name().str(), type, static_cast<uint32_t>(column._width)});
     }
+
+    ColumnarFile::write(filename, signals, with_time ? &time() : nullptr, values());
 }
 
 } // namespace pooya
@@ -18,10 +18,11 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_HELPER_HISTORY_HPP__
 #define __POOYA_HELPER_HISTORY_HPP__
 
+#include <memory>
 #include <sys/types.h>
-#include <unordered_map>
 #include <vector>
 
+#include "history_sink.hpp"
 #include "src/signal/array.hpp"
 #include "src/signal/signal.hpp"
 #include "src/signal/value_signal.hpp"
@@ -31,32 +32,88 @@ namespace pooya
 
 class Block;
 
-class History : public std::unordered_map<std::shared_ptr<ValueSignalImpl>, Eigen::MatrixXd>
+// Records the values of the tracked signals at the updates, a column per scalar and per element of an array, in the
+// order of tracking. Each signal is resolved to its columns and to a typed copy routine in track(), so an update only
+// gathers the values. The rows are stored in chunks of nrows_grow rows that are never reallocated, and the contiguous
+// time() and values() are assembled from them on the first access after an update. The accessors are therefore not safe
+// to call concurrently. Alternatively, the chunks can be streamed to a sink as they fill up, which keeps the memory
+// bounded regardless of the length of the run.
+class History
 {
-    using Base = std::unordered_map<std::shared_ptr<ValueSignalImpl>, Eigen::MatrixXd>;
-
-protected:
-    uint _nrows_grow;
-    uint _bottom_row{static_cast<uint>(-1)};
-    Array _time;
-    std::vector<std::shared_ptr<ValueSignalImpl>> _signals;
-
 public:
-    History(uint nrows_grow = 1000) : _nrows_grow(nrows_grow), _time(nrows_grow) {}
+    using Values = Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true>;
+
+    History(uint nrows_grow = 1000) : _nrows_grow(nrows_grow)
+    {
+        pooya_verify(nrows_grow > 0, "the chunks of the history should have at least one row!");
+    }
+    ~History();
 
     bool track(const Signal& sig);
     void untrack(const Signal& sig);
     void update(uint k, double t);
-    void export_csv(const std::string& filename);
+
+    // Streams the rows to the sink in batches of nrows_grow rows, written on a background thread, instead of keeping
+    // them. Called after the signals are tracked and before the history is updated. The rows are then updated in order
+    // and the accessors of the values are not available. close_sink() writes the remaining rows, closes the sink and
+    // leaves the history empty, the destructor does so too if it is not called.
+    void stream_to(HistorySink& sink);
+    void close_sink();
+    // the rows are formatted on num_threads threads, see CsvHistorySink
+    void export_csv(const std::string& filename, std::size_t num_threads = 1);
+
+    // writes the values, and the time if with_time is true, to a binary file that is read back by mapping it into
+    // memory, see ColumnarFile, the names of the tracked signals must be unique except for the unnamed ones
+    void export_columnar(const std::string& filename, bool with_time = true);
     void shrink_to_fit();
     uint nrows() const { return _bottom_row + 1; }
-    const Array& time() const { return _time; }
+    auto signals() const -> const auto& { return _signals; } // in the order of tracking
 
-    const Eigen::MatrixXd& operator[](const Signal& sig) const
+    const Array& time() const
     {
-        auto ptr = std::dynamic_pointer_cast<ValueSignalImpl>(sig->shared_from_this());
-        pooya_verify(ptr, "value signal expected!") return at(ptr);
+        assemble();
+        return _time;
     }
+
+    // the columns of all the signals
+    const Eigen::MatrixXd& values() const
+    {
+        assemble();
+        return _values;
+    }
+
+    Values operator[](const Signal& sig) const;
+
+protected:
+    // copies the value of a signal to dst, the elements of an array stride apart
+    using CopyFunction = void (*)(const ValueSignalImpl& sig, double* dst, Eigen::Index stride);
+
+    struct Column
+    {
+        const ValueSignalImpl* _sig;
+        Eigen::Index _col;   // the first column of the signal
+        Eigen::Index _width; // the number of columns of the signal
+        CopyFunction _copy;
+    };
+
+    uint _nrows_grow; // the rows of a chunk
+    uint _bottom_row{static_cast<uint>(-1)};
+    Eigen::Index _ncols{0};
+    std::vector<std::shared_ptr<ValueSignalImpl>> _signals;
+    std::vector<Column> _columns;         // parallel to _signals
+    std::vector<Eigen::MatrixXd> _chunks; // the time and then the columns of the signals
+    mutable Array _time;
+    mutable Eigen::MatrixXd _values;
+    mutable bool _assembled{false};
+    std::unique_ptr<HistoryWriter> _writer;
+    bool _streamed{false};
+    std::size_t _first_chunk{0}; // the index of the chunk in memory when streaming
+
+    // the names of the columns, starting with the time
+    std::vector<std::string> column_names() const;
+
+    // copies the chunks to _time and _values if they are out of date
+    void assemble() const;
 };
 
 } // namespace pooya
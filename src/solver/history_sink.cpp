@@ -0,0 +1,236 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <utility>
+
+#include "history_sink.hpp"
+#include "src/helper/trace.hpp"
+#include "src/helper/util.hpp"
+
+namespace pooya
+{
+
+namespace
+{
+
+// the most and the fewest rows of a block of CSV that are formatted together
+constexpr Eigen::Index csv_block_rows{1024};
+constexpr Eigen::Index csv_min_block_rows{64};
+
+// appends the rows [begin, end) as lines of CSV
+void format_csv(const Eigen::Ref<const Eigen::MatrixXd>& rows, Eigen::Index begin, Eigen::Index end, std::string& out)
+{
+    char buf[32]; // enough for the shortest round-trip form of any double
+    for (Eigen::Index k = begin; k < end; k++)
+    {
+        for (Eigen::Index j = 0; j < rows.cols(); j++)
+        {
+            if (j > 0)
+            {
+                out += ',';
+            }
+            const auto res = std::to_chars(buf, buf + sizeof(buf), rows(k, j));
+            out.append(buf, res.ptr);
+        }
+        out += '\n';
+    }
+}
+
+} // namespace
+
+CsvHistorySink::CsvHistorySink(const std::string& filename, std::size_t num_threads) : _filename(filename)
+{
+    if (num_threads > 1)
+    {
+        _thread_pool = std::make_unique<ThreadPool>(num_threads);
+    }
+}
+
+CsvHistorySink::~CsvHistorySink() = default;
+
+void CsvHistorySink::open(const std::vector<std::string>& names)
+{
+    pooya_trace("filename = " + _filename);
+
+    _ofs.open(_filename);
+    pooya_verify(_ofs.is_open(), _filename + ": cannot open the file!");
+    for (std::size_t k = 0; k < names.size(); k++)
+    {
+        _ofs << (k == 0 ? "" : ",") << names[k];
+    }
+    _ofs << "\n";
+}
+
+void CsvHistorySink::write(const Eigen::Ref<const Eigen::MatrixXd>& rows)
+{
+    // a few blocks per thread are formatted at a time, which bounds the memory of the text, and the blocks are sized by
+    // the batch so that a batch of fewer than csv_block_rows rows is still split among the threads
+    const std::size_t num_threads = _thread_pool ? _thread_pool->num_threads() : 1;
+    const Eigen::Index max_blocks = static_cast<Eigen::Index>(4 * num_threads);
+    const Eigen::Index block_rows =
+        std::clamp((rows.rows() + max_blocks - 1) / max_blocks, csv_min_block_rows, csv_block_rows);
+    const std::size_t num_blocks  = static_cast<std::size_t>((rows.rows() + block_rows - 1) / block_rows);
+    _blocks.resize(std::min(num_blocks, 4 * num_threads));
+
+    for (std::size_t first = 0; first < num_blocks; first += _blocks.size())
+    {
+        const std::size_t n = std::min(_blocks.size(), num_blocks - first);
+        auto format         = [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t b = begin; b < end; b++)
+            {
+                const Eigen::Index row = static_cast<Eigen::Index>(first + b) * block_rows;
+                _blocks[b].clear();
+                format_csv(rows, row, std::min(row + block_rows, rows.rows()), _blocks[b]);
+            }
+        };
+        if (_thread_pool)
+        {
+            _thread_pool->parallel_for(n, 1, format);
+        }
+        else
+        {
+            format(0, n);
+        }
+
+        for (std::size_t b = 0; b < n; b++)
+        {
+            _ofs.write(_blocks[b].data(), static_cast<std::streamsize>(_blocks[b].size()));
+        }
+    }
+    pooya_verify(_ofs.good(), _filename + ": cannot write to the file!");
+}
+
+void BinaryHistorySink::open(const std::vector<std::string>& names)
+{
+    pooya_trace("filename = " + _filename);
+
+    _ofs.open(_filename, std::ios::binary);
+    pooya_verify(_ofs.is_open(), _filename + ": cannot open the file!");
+
+    auto write_size = [this](std::uint64_t size) { _ofs.write(reinterpret_cast<const char*>(&size), sizeof(size)); };
+    write_size(names.size());
+    for (const auto& name : names)
+    {
+        write_size(name.size());
+        _ofs.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+}
+
+void BinaryHistorySink::write(const Eigen::Ref<const Eigen::MatrixXd>& rows)
+{
+    const std::uint64_t nrows = rows.rows();
+    _ofs.write(reinterpret_cast<const char*>(&nrows), sizeof(nrows));
+    for (Eigen::Index j = 0; j < rows.cols(); j++)
+    {
+        _ofs.write(reinterpret_cast<const char*>(rows.col(j).data()),
+                   static_cast<std::streamsize>(nrows * sizeof(double)));
+    }
+    pooya_verify(_ofs.good(), _filename + ": cannot write to the file!");
+}
+
+HistoryWriter::HistoryWriter(HistorySink& sink, const std::vector<std::string>& names, Eigen::Index nrows,
+                             Eigen::Index ncols)
+    : _sink(sink), _buffer(nrows, ncols)
+{
+    pooya_trace0;
+
+    _sink.open(names);
+    _thread = std::thread(&HistoryWriter::writer_loop, this);
+}
+
+HistoryWriter::~HistoryWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+}
+
+void HistoryWriter::write(Eigen::MatrixXd& batch, Eigen::Index nrows)
+{
+    pooya_trace0;
+    pooya_debug_verify0((batch.rows() == _buffer.rows()) && (batch.cols() == _buffer.cols()));
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        wait(lock);
+        _buffer.swap(batch);
+        _nrows   = nrows;
+        _pending = true;
+    }
+    _cv.notify_all();
+}
+
+void HistoryWriter::close()
+{
+    pooya_trace0;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        wait(lock);
+    }
+    _sink.close();
+}
+
+void HistoryWriter::wait(std::unique_lock<std::mutex>& lock)
+{
+    _cv.wait(lock, [this] { return !_pending; });
+    if (_exception)
+    {
+        std::rethrow_exception(std::exchange(_exception, nullptr));
+    }
+}
+
+void HistoryWriter::writer_loop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _cv.wait(lock, [this] { return _pending || _stop; });
+        if (!_pending)
+        {
+            return;
+        }
+
+        // the calling thread does not touch the buffer while the batch is pending
+        lock.unlock();
+        std::exception_ptr exception;
+        try
+        {
+            _sink.write(_buffer.topRows(_nrows));
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+        lock.lock();
+        if (exception)
+        {
+            _exception = exception;
+        }
+        _pending = false;
+        _cv.notify_all();
+    }
+}
+
+} // namespace pooya
@@ -0,0 +1,138 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_HISTORY_SINK_HPP__
+#define __POOYA_SOLVER_HISTORY_SINK_HPP__
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/signal/array.hpp"
+#include "thread_pool.hpp"
+
+namespace pooya
+{
+
+// A destination the rows of a History are streamed to, see History::stream_to(). The batches of rows arrive in order on
+// the writer thread of the history, column-major, with the time in the first column.
+class HistorySink
+{
+public:
+    virtual ~HistorySink() = default;
+
+    // called before the first batch with the names of the columns
+    virtual void open(const std::vector<std::string>& names) = 0;
+    virtual void write(const Eigen::Ref<const Eigen::MatrixXd>& rows) = 0;
+    // called after the last batch
+    virtual void close() = 0;
+};
+
+// discards the rows, e.g. to measure the cost of recording them
+class NullHistorySink : public HistorySink
+{
+public:
+    void open(const std::vector<std::string>& /*names*/) override {}
+    void write(const Eigen::Ref<const Eigen::MatrixXd>& rows) override { _num_rows += rows.rows(); }
+    void close() override {}
+
+    std::size_t num_rows() const { return _num_rows; }
+
+protected:
+    std::size_t _num_rows{0};
+};
+
+// Writes a header with the names of the columns and then a line per row, as History::export_csv() does. The values are
+// formatted with std::to_chars in the shortest form that reads back exactly, independent of the locale. Each batch is
+// split into a few blocks per thread that are formatted on num_threads threads and written in order.
+class CsvHistorySink : public HistorySink
+{
+public:
+    explicit CsvHistorySink(const std::string& filename, std::size_t num_threads = 1);
+    ~CsvHistorySink() override;
+
+    void open(const std::vector<std::string>& names) override;
+    void write(const Eigen::Ref<const Eigen::MatrixXd>& rows) override;
+    void close() override { _ofs.close(); }
+
+protected:
+    std::string _filename;
+    std::ofstream _ofs;
+    std::unique_ptr<ThreadPool> _thread_pool;
+    std::vector<std::string> _blocks; // the formatted blocks of rows, reused across the batches
+};
+
+// writes the number of columns and the names of the columns, each preceded by its length, and then each batch as the
+// number of its rows followed by its values column by column. The sizes are 64-bit unsigned integers, the values are
+// doubles, all in the native byte order.
+class BinaryHistorySink : public HistorySink
+{
+public:
+    explicit BinaryHistorySink(const std::string& filename) : _filename(filename) {}
+
+    void open(const std::vector<std::string>& names) override;
+    void write(const Eigen::Ref<const Eigen::MatrixXd>& rows) override;
+    void close() override { _ofs.close(); }
+
+protected:
+    std::string _filename;
+    std::ofstream _ofs;
+};
+
+// Writes the batches of rows to a sink on a thread of its own. While one batch is being written the next one is filled
+// in a second buffer, so at most two batches are in memory.
+class HistoryWriter
+{
+public:
+    // opens the sink, the batches have at most nrows rows of ncols columns
+    HistoryWriter(HistorySink& sink, const std::vector<std::string>& names, Eigen::Index nrows, Eigen::Index ncols);
+    HistoryWriter(const HistoryWriter&) = delete; // no copy constructor
+    ~HistoryWriter();
+
+    // hands the first nrows rows of the batch over to the writer thread and swaps in the buffer of the previous batch,
+    // waits for the previous batch to be written first
+    void write(Eigen::MatrixXd& batch, Eigen::Index nrows);
+
+    // waits for the last batch to be written and closes the sink
+    // an exception thrown by the sink on the writer thread is rethrown by write() or close()
+    void close();
+
+protected:
+    HistorySink& _sink;
+    Eigen::MatrixXd _buffer;
+    Eigen::Index _nrows{0}; // the rows of _buffer to write
+    bool _pending{false};
+    bool _stop{false};
+    std::exception_ptr _exception;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::thread _thread;
+
+    void writer_loop();
+    // waits for the pending batch to be written, the lock is held
+    void wait(std::unique_lock<std::mutex>& lock);
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_HISTORY_SINK_HPP__
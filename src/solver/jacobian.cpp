@@ -1,5 +1,5 @@
 /*
-Copyright 2024 Mojtaba (Moji) Fathi
+Copyright 2025 Mojtaba (Moji) Fathi
 
  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
 documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
@@ -15,25 +15,59 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER I
 OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-#include "rk4.hpp"
-#include "src/helper/trace.hpp"
+#include "jacobian.hpp"
 
 namespace pooya
 {
 
-void Rk4::step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+void Jacobian::init(std::size_t num_states)
 {
     pooya_trace0;
-    _callback = callback;
-    double h = new_h = t1 - t0;
-    double h_2       = h / 2;
 
-    _K1 = h_2 * f(t0, v0);
-    _K2 = h_2 * f(t0 + h_2, v0 + _K1);
-    _K3 = h * f(t0 + h_2, v0 + _K2);
-    _K4 = h * f(t0 + h, v0 + _K3);
+    _J.resize(num_states, num_states);
+    _M.resize(num_states, num_states);
+    _lu = Eigen::PartialPivLU<Eigen::MatrixXd>(num_states);
+    _x.resize(num_states);
+    _v.resize(num_states);
+    _fv.resize(num_states);
+    _valid      = false;
+    _factorized = false;
+}
+
+void Jacobian::set_pattern(const JacobianPattern* pattern)
+{
+    pooya_trace0;
+
+    _pattern = pattern;
+    if (_pattern)
+    {
+        _S = _pattern->pattern();
+    }
+    _valid      = false;
+    _factorized = false;
+}
+
+void Jacobian::factorize(double gamma)
+{
+    pooya_trace0;
 
-    v1 = v0 + (1. / 3) * _K1 + (2. / 3) * _K2 + (1. / 3) * _K3 + (1. / 6) * _K4;
+    if (_factorized && (gamma == _gamma))
+    {
+        return;
+    }
+
+    _M = -gamma * _J;
+    _M.diagonal().array() += 1;
+    _lu.compute(_M);
+    _gamma      = gamma;
+    _factorized = true;
+}
+
+void Jacobian::solve(Array& b)
+{
+    pooya_trace0;
+    _x = _lu.solve(b.matrix());
+    b  = _x.array();
 }
 
 } // namespace pooya
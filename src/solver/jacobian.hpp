@@ -0,0 +1,111 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_JACOBIAN_HPP__
+#define __POOYA_SOLVER_JACOBIAN_HPP__
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/LU"
+
+#include "jacobian_pattern.hpp"
+#include "src/helper/trace.hpp"
+#include "src/signal/array.hpp"
+
+namespace pooya
+{
+
+// The Jacobian of the derivatives with respect to the state variables, approximated with forward differences of the
+// derivative callback of a stepper, and the LU factorization of I - gamma * J that the implicit steppers solve with.
+// Both are kept until the stepper asks for a new one. Given the sparsity pattern of the model, the state variables that
+// do not affect the same derivatives are perturbed together.
+class Jacobian
+{
+public:
+    void init(std::size_t num_states);
+
+    // the pattern is owned by the simulator, nullptr perturbs one state variable at a time
+    void set_pattern(const JacobianPattern* pattern);
+
+    std::size_t size() const { return _v.size(); }
+    bool valid() const { return _valid; }
+
+    // fv is the derivative at (t, v), floor is the smallest magnitude each state variable is perturbed relative to
+    template<typename Callback>
+    void evaluate(Callback& f, double t, const Array& v, const Array& fv, const Array& floor)
+    {
+        pooya_trace0;
+
+        // f returns a reference to a storage that the next call overwrites
+        _fv = fv;
+        if (_pattern && (_pattern->size() == size()))
+        {
+            _pattern->evaluate(f, t, v, _fv, floor, _v, _S);
+            _J.setZero();
+            for (Eigen::Index col = 0; col < _S.outerSize(); col++)
+            {
+                for (Eigen::SparseMatrix<double>::InnerIterator it(_S, col); it; ++it)
+                {
+                    _J(it.row(), col) = it.value();
+                }
+            }
+        }
+        else
+        {
+            _v = v;
+            for (Eigen::Index k = 0; k < _v.size(); k++)
+            {
+                _v[k] = v[k] + _sqrt_eps * std::max(std::abs(v[k]), floor[k]);
+
+                const double dv = _v[k] - v[k];
+                _J.col(k)       = ((f(t, _v) - _fv) / dv).matrix();
+                _v[k]           = v[k];
+            }
+        }
+
+        _valid      = true;
+        _factorized = false;
+    }
+
+    // factorizes I - gamma * J unless it is already factorized with gamma
+    void factorize(double gamma);
+    bool factorized() const { return _factorized; }
+    double gamma() const { return _gamma; }
+
+    // solves (I - gamma * J) x = b in place
+    void solve(Array& b);
+
+protected:
+    static constexpr double _sqrt_eps{1.4901161193847656e-08}; // sqrt(std::numeric_limits<double>::epsilon())
+
+    const JacobianPattern* _pattern{nullptr};
+    Eigen::SparseMatrix<double> _S; // the nonzeros of _J, evaluated with the pattern
+    Eigen::MatrixXd _J;
+    Eigen::MatrixXd _M;
+    Eigen::PartialPivLU<Eigen::MatrixXd> _lu;
+    Eigen::VectorXd _x;
+    Array _v;
+    Array _fv;
+    double _gamma{0};
+    bool _valid{false};
+    bool _factorized{false};
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_JACOBIAN_HPP__
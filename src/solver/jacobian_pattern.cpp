@@ -0,0 +1,81 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "jacobian_pattern.hpp"
+
+namespace pooya
+{
+
+void JacobianPattern::init(std::size_t num_states, std::vector<std::vector<std::size_t>> columns)
+{
+    pooya_trace0;
+
+    columns.resize(num_states);
+
+    std::vector<Eigen::Triplet<double>> nonzeros;
+    std::vector<std::vector<std::size_t>> rows(num_states);
+    for (std::size_t col = 0; col < num_states; col++)
+    {
+        auto& column = columns[col];
+        std::sort(column.begin(), column.end());
+        column.erase(std::unique(column.begin(), column.end()), column.end());
+        for (auto row : column)
+        {
+            nonzeros.emplace_back(row, col, 1.0);
+            rows[row].push_back(col);
+        }
+    }
+
+    _pattern.resize(num_states, num_states);
+    _pattern.setFromTriplets(nonzeros.begin(), nonzeros.end());
+    _pattern.makeCompressed();
+
+    // greedy coloring, a column takes the first color none of the columns sharing a row with it has
+    constexpr std::size_t none = static_cast<std::size_t>(-1);
+    _colors.assign(num_states, none);
+    _groups.clear();
+    std::vector<std::size_t> taken; // the last column each color is found to be unavailable to
+    for (std::size_t col = 0; col < num_states; col++)
+    {
+        for (auto row : columns[col])
+        {
+            for (auto other : rows[row])
+            {
+                if (_colors[other] != none)
+                {
+                    taken[_colors[other]] = col;
+                }
+            }
+        }
+
+        std::size_t color = 0;
+        while ((color < taken.size()) && (taken[color] == col))
+        {
+            color++;
+        }
+        if (color == taken.size())
+        {
+            taken.push_back(none);
+            _groups.emplace_back();
+        }
+
+        _colors[col] = color;
+        _groups[color].push_back(col);
+    }
+}
+
+} // namespace pooya
@@ -0,0 +1,91 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_JACOBIAN_PATTERN_HPP__
+#define __POOYA_SOLVER_JACOBIAN_PATTERN_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Eigen/SparseCore"
+
+#include "src/helper/trace.hpp"
+#include "src/signal/array.hpp"
+
+namespace pooya
+{
+
+// The sparsity pattern of the Jacobian of the derivatives with respect to the state variables, and a coloring of its
+// columns. Columns of the same color have no nonzero row in common, so the corresponding state variables can be
+// perturbed together and the Jacobian approximated with one evaluation of the derivatives per color.
+class JacobianPattern
+{
+public:
+    // columns[j] lists the derivatives that depend on the state variable j
+    void init(std::size_t num_states, std::vector<std::vector<std::size_t>> columns);
+
+    std::size_t size() const { return _colors.size(); }
+
+    // the structural nonzeros, all equal to one
+    const Eigen::SparseMatrix<double>& pattern() const { return _pattern; }
+
+    std::size_t num_colors() const { return _groups.size(); }
+    std::size_t color(std::size_t col) const { return _colors[col]; }
+    const std::vector<std::size_t>& group(std::size_t color) const { return _groups[color]; }
+
+    // approximates the Jacobian at (t, v) with forward differences
+    // fv is the derivative at (t, v) and may not be the storage f returns, floor is the smallest magnitude each state
+    // variable is perturbed relative to, work is a scratch array of the size of v, and J has the nonzeros of pattern()
+    template<typename Callback>
+    void evaluate(Callback& f, double t, const Array& v, const Array& fv, const Array& floor, Array& work,
+                  Eigen::SparseMatrix<double>& J) const
+    {
+        pooya_trace0;
+
+        work = v;
+        for (const auto& group : _groups)
+        {
+            for (auto col : group)
+            {
+                work[col] = v[col] + _sqrt_eps * std::max(std::abs(v[col]), floor[col]);
+            }
+
+            const Array& fw = f(t, work);
+            for (auto col : group)
+            {
+                const double dv = work[col] - v[col];
+                for (Eigen::SparseMatrix<double>::InnerIterator it(J, col); it; ++it)
+                {
+                    it.valueRef() = (fw[it.row()] - fv[it.row()]) / dv;
+                }
+                work[col] = v[col];
+            }
+        }
+    }
+
+protected:
+    static constexpr double _sqrt_eps{1.4901161193847656e-08}; // sqrt(std::numeric_limits<double>::epsilon())
+
+    Eigen::SparseMatrix<double> _pattern;
+    std::vector<std::size_t> _colors;
+    std::vector<std::vector<std::size_t>> _groups; // the columns of each color
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_JACOBIAN_PATTERN_HPP__
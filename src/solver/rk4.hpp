@@ -18,23 +18,49 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_SOLVER_RK4_HPP__
 #define __POOYA_SOLVER_RK4_HPP__
 
-#include "stepper_base.hpp"
+#include "stepper.hpp"
 
 namespace pooya
 {
 
-class Rk4 : public StepperBase
+class Rk4 : public StepperT<Rk4>
 {
 protected:
     Array _K1;
     Array _K2;
     Array _K3;
     Array _K4;
+    Array _V; // the input of a stage
 
 public:
     Rk4() = default;
 
-    void step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h) override;
+    void init(std::size_t num_states) override
+    {
+        _K1.resize(num_states);
+        _K2.resize(num_states);
+        _K3.resize(num_states);
+        _K4.resize(num_states);
+        _V.resize(num_states);
+    }
+
+    template<typename Callback>
+    void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+    {
+        pooya_trace0;
+        double h = new_h = t1 - t0;
+        double h_2       = h / 2;
+
+        _K1 = h_2 * f(t0, v0);
+        _V  = v0 + _K1;
+        _K2 = h_2 * f(t0 + h_2, _V);
+        _V  = v0 + _K2;
+        _K3 = h * f(t0 + h_2, _V);
+        _V  = v0 + _K3;
+        _K4 = h * f(t0 + h, _V);
+
+        v1 = v0 + (1. / 3) * _K1 + (2. / 3) * _K2 + (1. / 3) * _K3 + (1. / 6) * _K4;
+    }
 };
 
 } // namespace pooya
@@ -18,12 +18,13 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_SOLVER_RKF45_HPP__
 #define __POOYA_SOLVER_RKF45_HPP__
 
-#include "stepper_base.hpp"
+#include "step_size_controller.hpp"
+#include "stepper.hpp"
 
 namespace pooya
 {
 
-class Rkf45 : public StepperBase
+class Rkf45 : public StepperT<Rkf45>
 {
 protected:
     Array _K1;
@@ -33,11 +34,60 @@ protected:
     Array _K5;
     Array _K6;
     Array _ZT;
+    Array _V; // the input of a stage
+    StepSizeController _controller;
 
 public:
-    Rkf45() = default;
+    // the default is the absolute tolerance the stepper had before its step size was controlled by StepSizeController
+    explicit Rkf45(double abs_tol = 1e-3, double rel_tol = 0) : _controller(5, abs_tol, rel_tol) {}
 
-    void step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h) override;
+    StepSizeController& controller() { return _controller; }
+
+    bool adaptive() const override { return true; }
+    bool accepted(double /*h*/, double /*new_h*/) const override { return _controller.accepted(); }
+
+    void init(std::size_t num_states) override
+    {
+        _controller.init(num_states);
+        _K1.resize(num_states);
+        _K2.resize(num_states);
+        _K3.resize(num_states);
+        _K4.resize(num_states);
+        _K5.resize(num_states);
+        _K6.resize(num_states);
+        _ZT.resize(num_states);
+        _V.resize(num_states);
+    }
+
+    void serialize(Archive& ar) override { _controller.serialize(ar); }
+
+    // source: https://ece.uwaterloo.ca/~dwharder/NumericalAnalysis/14IVPs/rkf45/complete.html
+    template<typename Callback>
+    void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+    {
+        pooya_trace0;
+        double h = t1 - t0;
+
+        _K1 = h * f(t0, v0);
+        _V  = v0 + 1. / 4 * _K1;
+        _K2 = h * f(t0 + 1. / 4 * h, _V);
+        _V  = v0 + (3. / 8 * 1. / 4) * _K1 + (3. / 8 * 3. / 4) * _K2;
+        _K3 = h * f(t0 + 3. / 8 * h, _V);
+        _V  = v0 + (12. / 13 * 161. / 169) * _K1 - (12. / 13 * 600. / 169) * _K2 + (12. / 13 * 608. / 169) * _K3;
+        _K4 = h * f(t0 + 12. / 13 * h, _V);
+        _V  = v0 + (8341. / 4104) * _K1 - (32832. / 4104) * _K2 + (29440. / 4104) * _K3 - (845. / 4104) * _K4;
+        _K5 = h * f(t1, _V);
+        _V  = v0 - (1. / 2 * 6080. / 10260) * _K1 + (1. / 2 * 41040. / 10260) * _K2 - (1. / 2 * 28352. / 10260) * _K3 +
+              (1. / 2 * 9295. / 10260) * _K4 - (1. / 2 * 5643. / 10260) * _K5;
+        _K6 = h * f(t0 + 1. / 2 * h, _V);
+
+        v1  = v0 + (2375. / 20520) * _K1 + (11264. / 20520) * _K3 + (10985. / 20520) * _K4 - (4104. / 20520) * _K5;
+        _ZT = v0 + (33440. / 282150) * _K1 + (146432. / 282150) * _K3 + (142805. / 282150) * _K4 -
+              (50787. / 282150) * _K5 + (10260. / 282150) * _K6;
+
+        _V    = v1 - _ZT;
+        new_h = _controller.next_step(h, _controller.error_norm(_V, v0, v1));
+    }
 };
 
 } // namespace pooya
@@ -0,0 +1,77 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "rosenbrock23.hpp"
+
+namespace pooya
+{
+
+void Rosenbrock23::init(std::size_t num_states)
+{
+    _controller.init(num_states);
+    _jac.init(num_states);
+    _dfdt.resize(num_states);
+    _V_jac.resize(num_states);
+    _F0.resize(num_states);
+    _F1.resize(num_states);
+    _F2.resize(num_states);
+    _K1.resize(num_states);
+    _K2.resize(num_states);
+    _K3.resize(num_states);
+    _T.resize(num_states);
+    _V.resize(num_states);
+    _V0.resize(num_states);
+    _V1.resize(num_states);
+    _refresh_jac = false;
+    _valid       = false;
+    _reusable    = false;
+}
+
+bool Rosenbrock23::reuse_first_stage(double t0, const Array& v0)
+{
+    if (!_reusable)
+    {
+        return false;
+    }
+
+    // the next step
+    if ((t0 == _t1) && (v0 == _V1).all())
+    {
+        _F0.swap(_F2);
+        return true;
+    }
+
+    // a rejected step being retried
+    return (t0 == _t0) && (v0 == _V0).all();
+}
+
+// source: Shampine and Reichelt, The MATLAB ODE Suite, the continuous extension of ode23s
+bool Rosenbrock23::interpolate(double t, Array& v) const
+{
+    pooya_trace0;
+    if (!_valid)
+    {
+        return false;
+    }
+
+    const double h = _t1 - _t0;
+    const double s = h != 0 ? (t - _t0) / h : 1;
+    v              = _V0 + (h * s * (1 - s) / (1 - 2 * _d)) * _K1 + (h * s * (s - 2 * _d) / (1 - 2 * _d)) * _K2;
+    return true;
+}
+
+} // namespace pooya
@@ -0,0 +1,158 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_ROSENBROCK23_HPP__
+#define __POOYA_SOLVER_ROSENBROCK23_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "jacobian.hpp"
+#include "step_size_controller.hpp"
+#include "stepper.hpp"
+
+namespace pooya
+{
+
+// The L-stable Rosenbrock 2(3) pair of MATLAB's ode23s (Shampine and Reichelt, The MATLAB ODE Suite), for stiff
+// models. A step costs 2 evaluations of the derivatives, since the last one is reused as the first one of the next step
+// unless the model changed at its end, see model_changed(), and 3 solves with one LU factorization of I - h * d * J.
+//
+// The method is not a W-method, its order and error estimate rely on the exact Jacobian at the start of the step. The
+// Jacobian is approximated with finite differences, with the columns grouped by the sparsity pattern of the model, at
+// the start of every step and only kept when a rejected step is retried from the same point.
+class Rosenbrock23 : public StepperT<Rosenbrock23>
+{
+protected:
+    StepSizeController _controller;
+    Jacobian _jac;
+    Array _dfdt;
+    double _t_jac{0};
+    Array _V_jac; // the state variables the Jacobian is evaluated at
+    bool _refresh_jac{false};
+
+    Array _F0;
+    Array _F1;
+    Array _F2;
+    Array _K1;
+    Array _K2;
+    Array _K3;
+    Array _T;
+    Array _V;
+    Array _V0; // the start of the last step
+    Array _V1; // the end of the last step
+    double _t0{0};
+    double _t1{0};
+    bool _valid{false};    // _F0 is the derivative at (_t0, _V0) and _F2 is the derivative at (_t1, _V1)
+    bool _reusable{false}; // _F0 and _F2 are still the derivatives of the model, see model_changed()
+
+    static constexpr double _d{0.29289321881345248};  // 1 / (2 + sqrt(2))
+    static constexpr double _e32{7.4142135623730950}; // 6 + sqrt(2)
+
+    // moves the derivative at (t0, v0) to _F0 if it is known from the last step
+    bool reuse_first_stage(double t0, const Array& v0);
+
+public:
+    explicit Rosenbrock23(double abs_tol = 1e-6, double rel_tol = 1e-3) : _controller(3, abs_tol, rel_tol) {}
+
+    StepSizeController& controller() { return _controller; }
+
+    bool adaptive() const override { return true; }
+    bool accepted(double /*h*/, double /*new_h*/) const override { return _controller.accepted(); }
+
+    void init(std::size_t num_states) override;
+    void set_jacobian_pattern(const JacobianPattern* pattern) override { _jac.set_pattern(pattern); }
+
+    // the last step is still interpolated, but its stages are not reused
+    void model_changed() override { _reusable = false; }
+
+    // the first stage of the next step and the Jacobian are evaluated again after loading
+    void serialize(Archive& ar) override
+    {
+        _controller.serialize(ar);
+        _valid       = _valid && !ar.loading();
+        _reusable    = _reusable && !ar.loading();
+        _refresh_jac = _refresh_jac || ar.loading();
+    }
+
+    // the 2nd order interpolant of the last step
+    bool interpolate(double t, Array& v) const override;
+
+    template<typename Callback>
+    void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+    {
+        pooya_trace0;
+        double h = t1 - t0;
+
+        if (static_cast<std::size_t>(v0.size()) != _jac.size())
+        {
+            init(v0.size());
+        }
+
+        if (!reuse_first_stage(t0, v0))
+        {
+            _F0 = f(t0, v0);
+        }
+        _valid    = false;
+        _reusable = false;
+
+        if (!_jac.valid() || _refresh_jac || (t0 != _t_jac) || !(v0 == _V_jac).all())
+        {
+            _jac.evaluate(f, t0, v0, _F0, _controller.abs_tol());
+
+            // the derivative with respect to time
+            const double sqrt_eps = std::sqrt(std::numeric_limits<double>::epsilon());
+            const double dt       = (t0 + std::min(sqrt_eps * std::max(std::abs(t0), std::abs(t1)), std::abs(h))) - t0;
+            _dfdt                 = (f(t0 + dt, v0) - _F0) / dt;
+
+            _t_jac       = t0;
+            _V_jac       = v0;
+            _refresh_jac = false;
+        }
+        _jac.factorize(h * _d);
+
+        _T  = (h * _d) * _dfdt;
+        _K1 = _F0 + _T;
+        _jac.solve(_K1);
+
+        _V  = v0 + (h / 2) * _K1;
+        _F1 = f(t0 + h / 2, _V);
+        _K2 = _F1 - _K1;
+        _jac.solve(_K2);
+        _K2 += _K1;
+
+        v1  = v0 + h * _K2;
+        _F2 = f(t1, v1);
+        _K3 = _F2 - _e32 * (_K2 - _F1) - 2 * (_K1 - _F0) + _T;
+        _jac.solve(_K3);
+
+        _V0       = v0;
+        _V1       = v1;
+        _t0       = t0;
+        _t1       = t1;
+        _valid    = true;
+        _reusable = true;
+
+        _V    = (h / 6) * (_K1 - 2 * _K2 + _K3);
+        new_h = _controller.next_step(h, _controller.error_norm(_V, v0, v1));
+    }
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_ROSENBROCK23_HPP__
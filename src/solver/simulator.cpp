@@ -21,8 +21,11 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <iostream>
 #endif // defined(POOYA_DEBUG)
 
+#include <unordered_map>
+
+#include "block_graph.hpp"
 #include "simulator.hpp"
-#include "src/block/block.hpp"
+#include "src/block/leaf.hpp"
 #include "src/helper/util.hpp"
 
 namespace pooya
@@ -38,60 +41,59 @@ void Simulator::process_model(double t, bool call_pre_step, bool call_post_step)
     }
     _model.input_cb(t);
 
-    if (call_pre_step) _model.pre_step(t);
+    update_rate_groups(t, call_post_step);
 
-    _model._mark_unprocessed();
+    if (call_pre_step) _model.pre_step(t);
 
-    if (_reuse_order)
+    if (_schedule_complete)
     {
-        _new_po->clear();
-
-        bool any_processed;
-        do
+        // the readiness of the leaves follows from the schedule, it is only checked in the debug builds
+        for (auto* leaf : _schedule)
         {
-            any_processed = false;
-            for (auto* base : *_current_po)
+            pooya_debug_verify(leaf->ready_to_process(), leaf->full_name().str() + ": not ready to be processed!");
+            if (!leaf->held())
             {
-                if (base->processed())
-                {
-                    continue;
-                }
-                base->process(t, false);
-                if (base->processed())
-                {
-                    _new_po->emplace_back(base);
-                    any_processed = true;
-                }
-            }
-        } while (any_processed);
-
-        for (auto* base : *_current_po)
-        {
-            if (!base->processed())
-            {
-                _new_po->emplace_back(base);
+                leaf->activation_function(t);
             }
         }
+    }
+    else
+    {
+        process_model_sweep(t);
+    }
 
-        pooya_debug_verify0(_current_po->size() == _new_po->size());
-        pooya_debug_verify0(_current_po->size() == _current_po->capacity());
-        pooya_debug_verify0(_new_po->size() == _new_po->capacity());
+    if (call_post_step) _model.post_step(t);
+}
+
+void Simulator::process_model_sweep(double t)
+{
+    pooya_trace("t: " + std::to_string(t));
 
-        std::swap(_current_po, _new_po);
+    _model._mark_unprocessed();
+    for (auto& loop : _algebraic_loops)
+    {
+        loop->_mark_unprocessed();
     }
-    else
+
+    for (auto* leaf : _schedule)
+    {
+        leaf->process(t, false);
+    }
+
+    // an algebraic loop is solved once the leaves it requires are processed
+    do
     {
         while (_model.process(t))
         {
         }
-    }
+    } while (process_algebraic_loops(t));
 
 #if defined(POOYA_DEBUG)
     std::vector<const Block*> unprocessed;
 
     auto find_unprocessed_cb = [&](const Block& c, uint32_t /*level*/) -> bool
     {
-        if (!c.processed())
+        if (!c.processed() && dynamic_cast<const Leaf*>(&c))
         {
             unprocessed.push_back(&c);
         }
@@ -116,8 +118,6 @@ void Simulator::process_model(double t, bool call_pre_step, bool call_post_step)
         }
     }
 #endif // defined(POOYA_DEBUG)
-
-    if (call_post_step) _model.post_step(t);
 }
 
 void Simulator::init(double t0)
@@ -126,31 +126,52 @@ void Simulator::init(double t0)
 
     SimulatorBase::init(t0);
 
-    if (_state_variables.size() > 0 && _reuse_order)
+    if (_reuse_order)
     {
-        pooya_debug_verify0(_processing_order1.empty());
-        pooya_debug_verify0(_processing_order2.empty());
-
-        uint num_blocks     = 0;
-        auto enum_blocks_cb = [&](Block& /*c*/, uint32_t /*level*/) -> bool
+        pooya_debug_verify0(_schedule.empty());
+
+        // the nodes of the schedule: the leaves in the visiting order of the model, with the leaves of each algebraic
+        // loop that is solved condensed into the loop where its first leaf is
+        BlockGraph graph(_model);
+        const auto& leaves = graph.leaves();
+        std::unordered_map<const Leaf*, AlgebraicLoop*> loops;
+        for (auto& loop : _algebraic_loops)
         {
-            num_blocks++;
-            return true;
-        };
-        _model.visit(enum_blocks_cb, 0);
-
-        _processing_order1.reserve(num_blocks);
-        _processing_order2.reserve(num_blocks);
+            for (const auto* leaf : loop->leaves())
+            {
+                loops[leaf] = loop.get();
+            }
+        }
 
-        auto add_blocks_cb = [&](Block& c, uint32_t /*level*/) -> bool
+        std::vector<Leaf*> nodes;
+        std::vector<std::size_t> node(leaves.size());
+        std::unordered_map<const AlgebraicLoop*, std::size_t> loop_nodes;
+        for (std::size_t k = 0; k < leaves.size(); k++)
         {
-            _processing_order1.emplace_back(&c);
-            return true;
-        };
-        _model.visit(add_blocks_cb, 0);
+            auto it = loops.find(leaves[k]);
+            if (it == loops.end())
+            {
+                node[k] = nodes.size();
+                nodes.push_back(leaves[k]);
+            }
+            else
+            {
+                auto [it_node, added] = loop_nodes.emplace(it->second, nodes.size());
+                if (added)
+                {
+                    nodes.push_back(it->second);
+                }
+                node[k] = it_node->second;
+            }
+        }
 
-        _current_po = &_processing_order1;
-        _new_po     = &_processing_order2;
+        std::vector<std::size_t> order;
+        _schedule_complete = graph.topological_order(node, nodes.size(), order);
+        _schedule.reserve(order.size());
+        for (auto n : order)
+        {
+            _schedule.push_back(nodes[n]);
+        }
     }
 
     process_model(t0, true, true);
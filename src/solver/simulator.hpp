@@ -20,12 +20,16 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include "simulator_base.hpp"
 
+#include <vector>
+
 namespace pooya
 {
 
 class Simulator : public SimulatorBase
 {
 public:
+    // with reuse_order, the leaves are processed in an order derived from the block graph once in init(), which is only
+    // right if the order does not change from one evaluation of the model to the next
     explicit Simulator(Block& model, SimulatorBase::InputCallback inputs_cb = nullptr, StepperBase* stepper = nullptr,
                        bool reuse_order = false)
         : SimulatorBase(model, inputs_cb, stepper), _reuse_order(reuse_order)
@@ -38,11 +42,15 @@ public:
 
 protected:
     const bool _reuse_order;
-    using ProcessingOrder = std::vector<Block*>;
-    ProcessingOrder _processing_order1;
-    ProcessingOrder _processing_order2;
-    ProcessingOrder* _current_po{nullptr};
-    ProcessingOrder* _new_po{nullptr};
+
+    // the leaves in a topological order of the block graph, with the leaves of each algebraic loop that is solved
+    // replaced by the loop, so that each of them is ready when it is reached. The leaves in or after an algebraic loop
+    // that is not solved are left out, the rest of the model is then swept repeatedly after the scheduled leaves.
+    std::vector<Leaf*> _schedule;
+    bool _schedule_complete{false};
+
+    // processes the scheduled leaves, then the rest of the model until no more leaf is ready
+    void process_model_sweep(double t);
 
     void process_model(double t, bool call_pre_step, bool call_post_step) override;
 };
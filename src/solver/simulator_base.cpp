@@ -15,10 +15,21 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER I
 OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <optional>
+#include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "block_graph.hpp"
+#include "history.hpp"
 #include "simulator_base.hpp"
-#include "src/block/block.hpp"
+#include "src/block/leaf.hpp"
+#include "src/block/submodel.hpp"
 #include "src/helper/util.hpp"
 
 namespace pooya
@@ -30,44 +41,80 @@ SimulatorBase::SimulatorBase(Block& model, InputCallback inputs_cb, StepperBase*
     pooya_trace("model: " + model.full_name().str());
 }
 
+SimulatorBase::~SimulatorBase()
+{
+    // move the values out of the arena and the assignments off the epochs before they are gone, leaving alone the
+    // signals another simulator of the same model bound since
+    const double* arena_begin = _arena.data();
+    const double* arena_end   = arena_begin + _arena.size();
+    for (auto& sig : scalar_signals_)
+    {
+        if ((sig->storage() >= arena_begin) && (sig->storage() < arena_end))
+        {
+            sig->bind_storage(nullptr);
+        }
+    }
+
+    std::unordered_set<const uint64_t*> epochs{&_epoch};
+    for (const auto& group : _rate_groups)
+    {
+        epochs.insert(&group._epoch);
+    }
+    for (auto& sig : value_signals_)
+    {
+        if (epochs.count(sig->epoch()) > 0)
+        {
+            sig->bind_epoch(nullptr);
+        }
+    }
+}
+
 void SimulatorBase::init(double t0)
 {
     pooya_trace("t0: " + std::to_string(t0));
 
     std::size_t state_variables_size{0};
+    std::size_t num_zero_crossings{0};
 
     std::unordered_set<ValueSignalImpl*> value_signals;
-    std::unordered_set<ScalarSignalImpl*> scalar_state_signals;
-#ifdef POOYA_ARRAY_SIGNAL
-    std::unordered_set<ArraySignalImpl*> array_state_signals;
-#endif // POOYA_ARRAY_SIGNAL
+    std::unordered_set<ScalarSignalImpl*> scalar_signals;
 
     _model.visit(
         [&](Block& block, uint32_t /*level*/) -> bool
         {
+            if (block.num_zero_crossings() > 0)
+            {
+                _zc_blocks.push_back(&block);
+                num_zero_crossings += block.num_zero_crossings();
+            }
+            _post_step_changes_outputs = _post_step_changes_outputs || block.post_step_changes_outputs();
+
             const auto& signals = block.linked_signals();
             for (auto& sig : signals)
             {
-                value_signals.insert(sig.first.get());
+                if (!value_signals.insert(sig.first.get()).second)
+                {
+                    continue;
+                }
+                value_signals_.emplace_back(sig.first);
 
                 if (auto* ps = dynamic_cast<ScalarSignalImpl*>(sig.first.get()); ps)
                 {
-                    if (ps->state_variable() &&
-                        scalar_state_signals
-                            .insert(std::static_pointer_cast<ScalarSignalImpl>(ps->shared_from_this()).get())
-                            .second)
+                    scalar_signals.insert(ps);
+                    scalar_signals_.emplace_back(std::static_pointer_cast<ScalarSignalImpl>(ps->shared_from_this()));
+                    if (ps->state_variable())
                     {
+                        scalar_state_signals_.emplace_back(scalar_signals_.back());
                         state_variables_size++;
                     }
                 }
 #ifdef POOYA_ARRAY_SIGNAL
                 else if (auto* pa = dynamic_cast<ArraySignalImpl*>(sig.first.get()); pa)
                 {
-                    if (pa->state_variable() &&
-                        array_state_signals
-                            .insert(std::static_pointer_cast<ArraySignalImpl>(pa->shared_from_this()).get())
-                            .second)
+                    if (pa->state_variable())
                     {
+                        array_state_signals_.emplace_back(
+                            std::static_pointer_cast<ArraySignalImpl>(pa->shared_from_this()));
                         state_variables_size += pa->size();
                     }
                 }
@@ -78,29 +125,42 @@ void SimulatorBase::init(double t0)
         },
         0);
 
-    value_signals_.reserve(value_signals.size());
-    for (auto* sig : value_signals)
-    {
-        value_signals_.emplace_back(std::static_pointer_cast<ValueSignalImpl>(sig->shared_from_this()));
-    }
-    scalar_state_signals_.reserve(scalar_state_signals.size());
-    for (auto* sig : scalar_state_signals)
-    {
-        scalar_state_signals_.emplace_back(std::static_pointer_cast<ScalarSignalImpl>(sig->shared_from_this()));
-    }
-#ifdef POOYA_ARRAY_SIGNAL
-    array_state_signals_.reserve(array_state_signals.size());
-    for (auto* sig : array_state_signals)
+    // The derivative of a state variable is not necessarily linked to any block, e.g. when it is set by the input
+    // callback. It still needs a slot in the arena.
+    for (auto& sig : scalar_state_signals_)
     {
-        array_state_signals_.emplace_back(std::static_pointer_cast<ArraySignalImpl>(sig->shared_from_this()));
+        auto* deriv = sig->deriv_signal();
+        if (scalar_signals.insert(deriv).second)
+        {
+            scalar_signals_.emplace_back(std::static_pointer_cast<ScalarSignalImpl>(deriv->shared_from_this()));
+        }
     }
-#endif // POOYA_ARRAY_SIGNAL
+
+    init_arena();
 
     _state_variables.resize(state_variables_size);
     _state_variables_orig.resize(state_variables_size);
     _state_variable_derivs.resize(state_variables_size);
 
+    init_jacobian_pattern();
+    init_rate_groups();
+    init_algebraic_loops();
+
+    _zc_a.resize(num_zero_crossings);
+    _zc_b.resize(num_zero_crossings);
+    _zc_m.resize(num_zero_crossings);
+    _zc_v.resize(state_variables_size);
+    _zc_vm.resize(state_variables_size);
+    _zc_valid = false;
+
+    if (_stepper)
+    {
+        _stepper->init(state_variables_size);
+        _stepper->set_jacobian_pattern(&_jac_pattern);
+    }
+
     _t_prev = t0;
+    _h_next = 0;
 
     if (state_variables_size == 0 && _stepper)
     {
@@ -116,34 +176,713 @@ void SimulatorBase::init(double t0)
     _initialized = true;
 }
 
-void SimulatorBase::run(double t, double min_time_step, double max_time_step)
+void SimulatorBase::init_arena()
+{
+    pooya_trace0;
+
+    // arena layout: scalar states, then the derivatives that are not states themselves, then the rest
+    const std::size_t num_states = scalar_state_signals_.size();
+
+    std::unordered_map<const ScalarSignalImpl*, std::size_t> offsets;
+    offsets.reserve(scalar_signals_.size());
+    std::vector<std::shared_ptr<ScalarSignalImpl>> ordered;
+    ordered.reserve(scalar_signals_.size());
+
+    auto add = [&](const std::shared_ptr<ScalarSignalImpl>& sig)
+    {
+        if (offsets.emplace(sig.get(), ordered.size()).second)
+        {
+            ordered.emplace_back(sig);
+        }
+    };
+
+    for (auto& sig : scalar_state_signals_)
+    {
+        add(sig);
+    }
+    for (auto& sig : scalar_state_signals_)
+    {
+        add(std::static_pointer_cast<ScalarSignalImpl>(sig->deriv_signal()->shared_from_this()));
+    }
+    for (auto& sig : scalar_signals_)
+    {
+        add(sig);
+    }
+
+    scalar_signals_ = std::move(ordered);
+
+    _deriv_offsets.clear();
+    _deriv_offsets.reserve(num_states);
+    _derivs_contiguous = true;
+    for (auto& sig : scalar_state_signals_)
+    {
+        _deriv_offsets.push_back(offsets.at(sig->deriv_signal()));
+        _derivs_contiguous = _derivs_contiguous && (_deriv_offsets.back() == num_states + _deriv_offsets.size() - 1);
+    }
+
+    // the arena starts on a cache line and its size is rounded up to whole cache lines, as aligned_alloc() requires
+    constexpr std::size_t cache_line{64};
+    const std::size_t num_bytes = (scalar_signals_.size() * sizeof(double) + cache_line - 1) / cache_line * cache_line;
+    _arena_data.reset(static_cast<double*>(std::aligned_alloc(cache_line, std::max(num_bytes, cache_line))));
+    pooya_verify(_arena_data, "cannot allocate the value arena!");
+    new (&_arena) Eigen::Map<Array, Eigen::Aligned64>(_arena_data.get(), scalar_signals_.size());
+    _arena.setZero();
+    double* data = _arena.data();
+    for (auto& sig : scalar_signals_)
+    {
+        sig->bind_storage(data++);
+    }
+}
+
+void SimulatorBase::init_jacobian_pattern()
+{
+    pooya_trace0;
+
+    // the state variables each signal holds and the ones it is the derivative of, as (offset, size) in the state
+    // variables array
+    using Segment = std::pair<std::size_t, std::size_t>;
+    std::vector<std::pair<const ValueSignalImpl*, Segment>> states;
+    std::unordered_set<const ValueSignalImpl*> is_state;
+    std::unordered_map<const ValueSignalImpl*, std::vector<Segment>> derivs;
+
+    std::size_t offset{0};
+    for (auto& sig : scalar_state_signals_)
+    {
+        states.emplace_back(sig.get(), Segment{offset, 1});
+        is_state.insert(sig.get());
+        derivs[sig->deriv_signal()].emplace_back(offset, 1);
+        offset++;
+    }
+#ifdef POOYA_ARRAY_SIGNAL
+    for (auto& sig : array_state_signals_)
+    {
+        states.emplace_back(sig.get(), Segment{offset, sig->size()});
+        is_state.insert(sig.get());
+        derivs[sig->deriv_signal()].emplace_back(offset, sig->size());
+        offset += sig->size();
+    }
+#endif // POOYA_ARRAY_SIGNAL
+
+    // the leaves that require each signal and the signals the leaves output
+    std::unordered_map<const ValueSignalImpl*, std::vector<const Leaf*>> consumers;
+    std::unordered_set<const ValueSignalImpl*> outputs;
+    _model.visit(
+        [&](Block& block, uint32_t /*level*/) -> bool
+        {
+            if (const auto* leaf = dynamic_cast<const Leaf*>(&block); leaf)
+            {
+                for (const auto& [sig, type] : leaf->linked_signals())
+                {
+                    if (type & Block::SignalLinkType::Required)
+                    {
+                        consumers[sig.get()].push_back(leaf);
+                    }
+                    if (type & Block::SignalLinkType::Output)
+                    {
+                        outputs.insert(sig.get());
+                    }
+                }
+            }
+            return true;
+        },
+        0);
+
+    // the signals the sources reach through the direct feedthroughs of the leaves, the state variables themselves are
+    // set by the simulator and stop the search
+    std::unordered_set<const ValueSignalImpl*> reached;
+    std::vector<const ValueSignalImpl*> queue;
+    auto reach = [&](const std::vector<const ValueSignalImpl*>& sources)
+    {
+        reached.clear();
+        reached.insert(sources.begin(), sources.end());
+        queue = sources;
+        for (std::size_t n = 0; n < queue.size(); n++)
+        {
+            auto it = consumers.find(queue[n]);
+            if (it == consumers.end())
+            {
+                continue;
+            }
+            for (const auto* leaf : it->second)
+            {
+                for (const auto& [sig, type] : leaf->linked_signals())
+                {
+                    if ((type & Block::SignalLinkType::Output) && !is_state.count(sig.get()) &&
+                        reached.insert(sig.get()).second)
+                    {
+                        queue.push_back(sig.get());
+                    }
+                }
+            }
+        }
+    };
+
+    // the rows of the derivatives among the reached signals
+    auto reached_rows = [&](const std::function<void(std::size_t)>& add_row)
+    {
+        for (const auto* sig : queue)
+        {
+            auto it = derivs.find(sig);
+            if (it == derivs.end())
+            {
+                continue;
+            }
+            for (const auto& [row, num_rows] : it->second)
+            {
+                for (std::size_t k = row; k < row + num_rows; k++)
+                {
+                    add_row(k);
+                }
+            }
+        }
+    };
+
+    std::vector<std::vector<std::size_t>> columns(offset);
+    for (const auto& [state, cols] : states)
+    {
+        reach({state});
+        reached_rows(
+            [&](std::size_t row)
+            {
+                for (std::size_t col = cols.first; col < cols.first + cols.second; col++)
+                {
+                    columns[col].push_back(row);
+                }
+            });
+    }
+
+    // The signals no leaf outputs, e.g. the inputs or the derivatives the input callback assigns, may be computed from
+    // any state variable, which is invisible to the block graph. The derivatives they reach depend on all of them.
+    std::unordered_set<const ValueSignalImpl*> external;
+    for (const auto& sig : value_signals_)
+    {
+        external.insert(sig.get());
+    }
+    for (const auto& [sig, segments] : derivs)
+    {
+        external.insert(sig);
+    }
+    for (const auto* sig : outputs)
+    {
+        external.erase(sig);
+    }
+    for (const auto* sig : is_state)
+    {
+        external.erase(sig);
+    }
+    reach({external.begin(), external.end()});
+    reached_rows(
+        [&](std::size_t row)
+        {
+            for (auto& column : columns)
+            {
+                column.push_back(row);
+            }
+        });
+
+    _jac_pattern.init(offset, std::move(columns));
+}
+
+void SimulatorBase::init_rate_groups()
+{
+    pooya_trace0;
+
+    std::vector<Leaf*> leaves;
+    _model.visit(
+        [&](Block& block, uint32_t /*level*/) -> bool
+        {
+            if (auto* leaf = dynamic_cast<Leaf*>(&block); leaf)
+            {
+                leaves.push_back(leaf);
+            }
+            return true;
+        },
+        0);
+
+    std::unordered_map<const ValueSignalImpl*, std::vector<std::size_t>> producers;
+    for (std::size_t k = 0; k < leaves.size(); k++)
+    {
+        for (const auto& [sig, type] : leaves[k]->linked_signals())
+        {
+            if (type & Block::SignalLinkType::Output)
+            {
+                producers[sig.get()].push_back(k);
+            }
+        }
+    }
+
+    // the sample times the leaves or their submodels declare
+    std::vector<SampleTime> sample_times;
+    std::vector<bool> resolved;
+    sample_times.reserve(leaves.size());
+    resolved.reserve(leaves.size());
+    for (auto* leaf : leaves)
+    {
+        SampleTime sample_time = leaf->sample_time();
+        for (auto* parent = leaf->parent(); sample_time.is_inherited() && parent; parent = parent->parent())
+        {
+            sample_time = parent->sample_time();
+        }
+        sample_times.push_back(sample_time);
+        resolved.push_back(!sample_time.is_inherited());
+    }
+
+    // the inherited ones, from the leaves driving the inputs
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (std::size_t k = 0; k < leaves.size(); k++)
+        {
+            if (resolved[k])
+            {
+                continue;
+            }
+
+            std::optional<SampleTime> common;
+            bool discrete{true};
+            bool constant{leaves[k]->time_invariant()};
+            bool known{true};
+            bool fed{false};
+            for (const auto& [sig, type] : leaves[k]->linked_signals())
+            {
+                if (!(type & Block::SignalLinkType::Input))
+                {
+                    continue;
+                }
+                auto it = producers.find(sig.get());
+                if (it == producers.end())
+                {
+                    // assigned by the input callback or a state variable
+                    discrete = false;
+                    constant = false;
+                    break;
+                }
+                for (auto p : it->second)
+                {
+                    fed = true;
+                    if (!resolved[p])
+                    {
+                        known = false;
+                    }
+                    else if (sample_times[p].is_constant())
+                    {
+                        // held all the time, so it does not change the rate of the leaf
+                    }
+                    else if (!sample_times[p].is_discrete() || (common && (*common != sample_times[p])))
+                    {
+                        discrete = false;
+                        constant = false;
+                    }
+                    else
+                    {
+                        common   = sample_times[p];
+                        constant = false;
+                    }
+                }
+            }
+
+            if (!discrete || known)
+            {
+                if (constant && fed)
+                {
+                    sample_times[k] = SampleTime::constant();
+                }
+                else
+                {
+                    sample_times[k] = (discrete && common) ? *common : SampleTime::continuous();
+                }
+                resolved[k] = true;
+                changed     = true;
+            }
+        }
+    }
+
+    // the continuous leaves whose outputs only depend on time, e.g. the sources and the time-invariant leaves they feed
+    std::vector<bool> time_only(leaves.size(), false);
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (std::size_t k = 0; k < leaves.size(); k++)
+        {
+            if (time_only[k] || !resolved[k] || !sample_times[k].is_continuous())
+            {
+                continue;
+            }
+
+            bool only{leaves[k]->time_only()};
+            if (!only && leaves[k]->time_invariant())
+            {
+                bool fed{false};
+                only = true;
+                for (const auto& [sig, type] : leaves[k]->linked_signals())
+                {
+                    if (!(type & Block::SignalLinkType::Input))
+                    {
+                        continue;
+                    }
+                    auto it = producers.find(sig.get());
+                    if (it == producers.end())
+                    {
+                        only = false;
+                        break;
+                    }
+                    for (auto p : it->second)
+                    {
+                        fed  = fed || time_only[p];
+                        only = only && (time_only[p] || sample_times[p].is_constant());
+                    }
+                }
+                only = only && fed;
+            }
+
+            if (only)
+            {
+                time_only[k] = true;
+                changed      = true;
+            }
+        }
+    }
+
+    // the rate groups, the time-only leaves are in the continuous one
+    std::unordered_set<const ValueSignalImpl*> sampled_outputs;
+    for (std::size_t k = 0; k < leaves.size(); k++)
+    {
+        if (!resolved[k] || !(sample_times[k].is_discrete() || sample_times[k].is_constant() || time_only[k]))
+        {
+            continue;
+        }
+
+        auto it = std::find_if(_rate_groups.begin(), _rate_groups.end(),
+                               [&](const RateGroup& group) { return group._sample_time == sample_times[k]; });
+        if (it == _rate_groups.end())
+        {
+            it = _rate_groups.insert(_rate_groups.end(), RateGroup{sample_times[k], {}, {}, false, 0});
+        }
+
+        it->_leaves.push_back(leaves[k]);
+        _leaf_groups[leaves[k]] = static_cast<std::size_t>(it - _rate_groups.begin());
+        for (const auto& [sig, type] : leaves[k]->linked_signals())
+        {
+            if ((type & Block::SignalLinkType::Output) && sampled_outputs.insert(sig.get()).second)
+            {
+                it->_outputs.push_back(sig.get());
+            }
+        }
+    }
+
+    // the outputs of the rate groups are cleared with the epochs of the groups
+    for (auto& sig : value_signals_)
+    {
+        sig->bind_epoch(&_epoch);
+    }
+    for (auto& group : _rate_groups)
+    {
+        for (auto* sig : group._outputs)
+        {
+            sig->bind_epoch(&group._epoch);
+        }
+    }
+}
+
+void SimulatorBase::init_algebraic_loops()
+{
+    pooya_trace0;
+
+    BlockGraph graph(_model);
+    std::vector<std::vector<std::size_t>> loops;
+    graph.algebraic_loops(loops);
+
+    for (const auto& loop : loops)
+    {
+        const auto& first = *graph.leaves()[loop.front()];
+
+        // a held leaf would keep the loop from converging
+        if (std::any_of(loop.begin(), loop.end(),
+                        [&](std::size_t k) { return rate_group(*graph.leaves()[k]) != nullptr; }))
+        {
+            helper::pooya_show_warning(__FILE__, __LINE__,
+                                       first.full_name().str() +
+                                           ": an algebraic loop with a discrete leaf is not supported!");
+            continue;
+        }
+
+        auto algebraic_loop = std::make_unique<AlgebraicLoop>(graph, loop);
+        if (!algebraic_loop->valid())
+        {
+            helper::pooya_show_warning(__FILE__, __LINE__,
+                                       first.full_name().str() +
+                                           ": an algebraic loop without a scalar signal to tear is not supported!");
+            continue;
+        }
+        _algebraic_loops.emplace_back(std::move(algebraic_loop));
+    }
+}
+
+bool SimulatorBase::process_algebraic_loops(double t)
+{
+    pooya_trace("t: " + std::to_string(t));
+
+    bool processed{false};
+    for (auto& loop : _algebraic_loops)
+    {
+        processed = (loop->process(t, false) > 0) || processed;
+    }
+    return processed;
+}
+
+void SimulatorBase::clear_signals()
+{
+    pooya_trace0;
+    _epoch++;
+}
+
+void SimulatorBase::update_rate_groups(double t, bool call_post_step)
 {
     pooya_trace("t: " + std::to_string(t));
 
-    auto minor_solver_step_cb = [&](double t, const Array& state_variables) -> const Array&
+    for (auto& group : _rate_groups)
     {
-        pooya_trace("t: " + std::to_string(t));
+        const auto& sample_time = group._sample_time;
 
-        reset_with_state_variables(state_variables);
-        process_model(t, false, false);
+        // the time-only leaves are reused in the evaluations at the same time, e.g. the stages of a step that share it
+        const bool active = !group._evaluated ||
+                            (sample_time.is_continuous() ? (t != group._t) : (call_post_step && sample_time.hit(t)));
+        if (active)
+        {
+            group._epoch++;
 
-        double* data = _state_variable_derivs.data();
-        for (auto& sig : scalar_state_signals_)
+            // only the discrete ones depend on the state variables, so any other evaluation will do
+            group._evaluated = group._evaluated || call_post_step || !sample_time.is_discrete();
+            group._t         = t;
+        }
+        group._active = active;
+        for (auto* leaf : group._leaves)
         {
-            *data = sig->deriv_signal()->get_value();
-            data++;
+            leaf->set_held(!active);
         }
-#ifdef POOYA_ARRAY_SIGNAL
-        for (auto& sig : array_state_signals_)
+    }
+}
+
+double SimulatorBase::limit_to_sample_hits(double t1, double t2) const
+{
+    for (const auto& group : _rate_groups)
+    {
+        const auto& sample_time = group._sample_time;
+        if (!sample_time.is_discrete())
+        {
+            continue;
+        }
+
+        const double hit = sample_time.next_hit(t1);
+
+        // t2 may already be the same hit, rounded differently
+        if ((hit < t2) && !(sample_time.hit(t2) && (t2 - hit < sample_time.period() / 2)))
+        {
+            t2 = hit;
+        }
+    }
+    return t2;
+}
+
+bool SimulatorBase::changed_in_post_step(double t) const
+{
+    if (_post_step_changes_outputs)
+    {
+        return true;
+    }
+
+    for (const auto& group : _rate_groups)
+    {
+        if (group._sample_time.is_discrete() && group._sample_time.hit(t))
         {
-            auto* deriv_sig                            = sig->deriv_signal();
-            Eigen::Map<Array>(data, deriv_sig->size()) = deriv_sig->get_value();
-            data += deriv_sig->size();
+            return true;
+        }
+    }
+    return false;
+}
+
+void SimulatorBase::parameters_changed()
+{
+    pooya_trace0;
+
+    // the time-only leaves may be fed by the constant ones
+    for (auto& group : _rate_groups)
+    {
+        if (!group._sample_time.is_discrete())
+        {
+            group._evaluated = false;
         }
+    }
+
+    // the derivatives the stepper keeps from the last step are evaluated with the old parameters
+    if (_stepper)
+    {
+        _stepper->model_changed();
+    }
+}
+
+auto SimulatorBase::rate_group(const Leaf& leaf) const -> const RateGroup*
+{
+    auto it = _leaf_groups.find(&leaf);
+    return it == _leaf_groups.end() ? nullptr : &_rate_groups[it->second];
+}
+
+namespace
+{
+
+// saves or loads the value of the signal if it is of type T, returns false if it is not
+template<typename T>
+bool serialize_value_as(Archive& ar, ValueSignalImpl& sig)
+{
+    auto* typed = dynamic_cast<typename Types<T>::SignalImpl*>(&sig);
+    if (!typed)
+    {
+        return false;
+    }
+
+    bool assigned = sig.assigned();
+    ar(assigned);
+    if (!assigned)
+    {
+        sig.clear();
+        return true;
+    }
+
+    T value{};
+    if (!ar.loading())
+    {
+        value = typed->get_value();
+    }
+    ar(value);
+    if (ar.loading())
+    {
+        sig.clear();
+        typed->set_value(value);
+    }
+    return true;
+}
+
+void serialize_value(Archive& ar, ValueSignalImpl& sig)
+{
+    bool done = serialize_value_as<double>(ar, sig);
+#ifdef POOYA_INT_SIGNAL
+    done = done || serialize_value_as<int>(ar, sig);
+#endif // POOYA_INT_SIGNAL
+#ifdef POOYA_BOOL_SIGNAL
+    done = done || serialize_value_as<bool>(ar, sig);
+#endif // POOYA_BOOL_SIGNAL
+#ifdef POOYA_ARRAY_SIGNAL
+    done = done || serialize_value_as<Array>(ar, sig);
 #endif // POOYA_ARRAY_SIGNAL
+    pooya_verify(done, sig.name().str() + ": checkpoint: unsupported signal type!");
+}
 
-        return _state_variable_derivs;
-    };
+} // namespace
+
+Archive::Blob SimulatorBase::save_checkpoint()
+{
+    pooya_trace0;
+
+    Archive ar;
+    serialize(ar);
+    return ar.blob();
+}
+
+void SimulatorBase::load_checkpoint(const Archive::Blob& blob)
+{
+    pooya_trace0;
+
+    Archive ar(blob);
+    serialize(ar);
+    pooya_verify(ar.at_end(), "checkpoint: unexpected data at the end!");
+
+    // the leaves that are not discrete do not depend on the past, they are evaluated again
+    for (auto& group : _rate_groups)
+    {
+        if (!group._sample_time.is_discrete())
+        {
+            group._evaluated = false;
+        }
+    }
+    _zc_valid = false;
+    _loaded   = true;
+}
+
+void SimulatorBase::fork(const std::vector<SimulatorBase*>& clones)
+{
+    pooya_trace0;
+
+    const auto blob = save_checkpoint();
+    for (auto* clone : clones)
+    {
+        pooya_verify(clone && (clone != this), "fork: invalid clone!");
+        if (!clone->_initialized)
+        {
+            clone->init(_t_prev);
+        }
+        clone->load_checkpoint(blob);
+    }
+}
+
+void SimulatorBase::serialize(Archive& ar)
+{
+    pooya_trace0;
+
+    pooya_verify(_initialized, "checkpoint: the simulator is not initialized!");
+
+    // the format version and the shape of the model, to catch loading a checkpoint of another one
+    constexpr std::size_t version{2};
+    std::size_t num_blocks{0};
+    _model.visit(
+        [&](Block& /*block*/, uint32_t /*level*/) -> bool
+        {
+            num_blocks++;
+            return true;
+        },
+        0);
+    const std::vector<std::size_t> expected{version, num_blocks, static_cast<std::size_t>(_state_variables.size()),
+                                            _rate_groups.size()};
+    auto header = expected;
+    ar(header);
+    pooya_verify(header == expected, "checkpoint: the model does not match!");
+
+    // the state of the stepper is only meaningful to a stepper of the same type
+    const char* stepper_name = _stepper ? typeid(*_stepper).name() : "";
+    const std::vector<char> expected_stepper(stepper_name, stepper_name + std::strlen(stepper_name));
+    auto stepper = expected_stepper;
+    ar(stepper);
+    pooya_verify(stepper == expected_stepper, "checkpoint: the stepper does not match!");
+
+    ar(_t_prev);
+    ar(_h_next);
+    ar(_state_variables);
+    if (_stepper)
+    {
+        _stepper->serialize(ar);
+    }
+
+    for (auto& group : _rate_groups)
+    {
+        ar(group._evaluated);
+        ar(group._t);
+        for (auto* sig : group._outputs)
+        {
+            serialize_value(ar, *sig);
+        }
+    }
+
+    _model.visit(
+        [&](Block& block, uint32_t /*level*/) -> bool
+        {
+            block.serialize(ar);
+            return true;
+        },
+        0);
+}
+
+void SimulatorBase::run(double t, double min_time_step, double max_time_step)
+{
+    pooya_trace("t: " + std::to_string(t));
 
     if (!_initialized)
     {
@@ -167,15 +906,15 @@ void SimulatorBase::run(double t, double min_time_step, double max_time_step)
 
         if (t == _t_prev)
         {
-            helper::pooya_show_warning(__FILE__, __LINE__,
-                                       "Repeated simulation step:\n  "
-                                       "- time = " +
-                                           std::to_string(t) + "\n");
-
-            for (auto& sig : value_signals_)
+            if (!_loaded)
             {
-                sig->clear();
+                helper::pooya_show_warning(__FILE__, __LINE__,
+                                           "Repeated simulation step:\n  "
+                                           "- time = " +
+                                               std::to_string(t) + "\n");
             }
+
+            clear_signals();
             if (_inputs_cb)
             {
                 _inputs_cb(_model, t);
@@ -191,16 +930,16 @@ void SimulatorBase::run(double t, double min_time_step, double max_time_step)
             pooya_debug_verify0(min_time_step > 0);
             pooya_debug_verify0(max_time_step > min_time_step);
 
+            // an adaptive stepper continues with the step size it chose during the previous call
+            const bool adaptive = _stepper->adaptive();
             double new_h;
             double t1         = _t_prev;
-            double t2         = t;
+            double t2         = (adaptive && (_h_next > 0)) ? std::min(t1 + _h_next, t) : t;
+            t2                = limit_to_sample_hits(t1, t2);
             bool force_accept = false;
             while (t1 < t)
             {
-                for (auto& sig : value_signals_)
-                {
-                    sig->clear();
-                }
+                clear_signals();
                 if (_inputs_cb)
                 {
                     _inputs_cb(_model, t1);
@@ -209,21 +948,48 @@ void SimulatorBase::run(double t, double min_time_step, double max_time_step)
                 _model.pre_step(t1);
                 get_state_variables(_state_variables_orig);
 
-                _stepper->step(minor_solver_step_cb, t1, _state_variables_orig, t2, _state_variables, new_h);
+                _stepper->step_model(*this, t1, _state_variables_orig, t2, _state_variables, new_h);
 
-                double h = t2 - t1;
-                if (force_accept || (new_h >= h) || (h <= min_time_step))
+                double h          = t2 - t1;
+                const bool failed = _stepper->failed();
+                pooya_verify(!failed || (h > min_time_step),
+                             "the stepper failed to make a step of the minimum size at t = " + std::to_string(t1) +
+                                 "!");
+                if (!failed && (force_accept || _stepper->accepted(h, new_h) || (h <= min_time_step)))
                 {
                     // accept this step
                     force_accept = false;
                     new_h        = std::max(min_time_step, std::min(new_h, max_time_step));
-                    t1           = t2;
-                    t2           = std::min(t1 + new_h, t);
+                    // a step cut short to land on t says little about the size of the next one
+                    if (adaptive && ((t2 < t) || (h >= _h_next) || (new_h > _h_next)))
+                    {
+                        _h_next = new_h;
+                    }
+                    const bool event = !_zc_blocks.empty() &&
+                                       locate_event(t1, _state_variables_orig, t2, _state_variables);
+                    if (_output)
+                    {
+                        record_output(t1, _state_variables_orig, t2);
+                    }
+                    if (event)
+                    {
+                        // the derivatives may jump at the event, neither the stages or the history of the stepper nor
+                        // its step size carry over, the next step starts like the first one
+                        _stepper->model_changed();
+                        _h_next = 0;
+                        new_h   = max_time_step;
+                    }
+                    t1 = t2;
+                    t2 = limit_to_sample_hits(t1, std::min(t1 + new_h, t));
 
                     if (t1 < t)
                     {
                         reset_with_state_variables(_state_variables);
                         process_model(t1, false, true);
+                        if (changed_in_post_step(t1))
+                        {
+                            _stepper->model_changed();
+                        }
                     }
                 }
                 else
@@ -231,7 +997,8 @@ void SimulatorBase::run(double t, double min_time_step, double max_time_step)
                     // redo this step
                     force_accept = new_h <= min_time_step;
                     new_h        = std::max(min_time_step, std::min(new_h, max_time_step));
-                    t2           = t1 + new_h;
+                    t2           = limit_to_sample_hits(t1, std::min(t1 + new_h, t));
+                    _h_next      = new_h;
                 }
             }
         }
@@ -239,24 +1006,169 @@ void SimulatorBase::run(double t, double min_time_step, double max_time_step)
 
     reset_with_state_variables(_state_variables);
     process_model(t, _state_variables.size() == 0, true);
+    if (_stepper && changed_in_post_step(t))
+    {
+        _stepper->model_changed();
+    }
 
     _t_prev = t;
+    _loaded = false;
 }
 
-void SimulatorBase::reset_with_state_variables(const Array& state_variables)
+void SimulatorBase::run(History& history, double t0, double t1, double dt, double min_time_step, double max_time_step)
 {
-    pooya_trace0;
-    for (auto& sig : value_signals_)
+    pooya_trace("t0: " + std::to_string(t0));
+    pooya_verify((dt > 0) && (t1 >= t0), "invalid time span!");
+
+    if (!_initialized)
     {
-        sig->clear();
+        init(t0);
+    }
+    pooya_verify(t0 == _t_prev, "the history should start at the current time!");
+    history.update(0, t0);
+
+    const auto last = static_cast<uint>(std::floor((t1 - t0) / dt + 1e-9));
+    if ((last == 0) || !_stepper || !_stepper->adaptive())
+    {
+        for (uint k = 1; k <= last; k++)
+        {
+            // the same expression as the one used for the other rows
+            const double t = t0 + k * dt;
+            run(t, min_time_step, max_time_step);
+            history.update(k, t);
+        }
+        return;
+    }
+
+    _output      = &history;
+    _output_t0   = t0;
+    _output_dt   = dt;
+    _output_k    = 1;
+    _output_last = last;
+    _output_v.resize(_state_variables.size());
+
+    const double t = t0 + last * dt;
+    try
+    {
+        run(t, min_time_step, max_time_step);
+    }
+    catch (...)
+    {
+        _output = nullptr;
+        throw;
+    }
+    _output = nullptr;
+
+    pooya_verify(_output_k == last, "some rows of the history are not updated!");
+    history.update(last, t);
+}
+
+void SimulatorBase::record_output(double t1, const Array& v1, double t2)
+{
+    pooya_trace("t1: " + std::to_string(t1));
+
+    for (; _output_k < _output_last; _output_k++)
+    {
+        const double t = _output_t0 + _output_k * _output_dt;
+        if (t > t2)
+        {
+            break;
+        }
+
+        if (!_stepper->interpolate(t, _output_v))
+        {
+            // a step to the output time only probes the step, it must not change the state of the stepper
+            Archive stepper_state;
+            _stepper->serialize(stepper_state);
+            double new_h;
+            _stepper->step_model(*this, t1, v1, t, _output_v, new_h);
+            Archive ar(stepper_state.blob());
+            _stepper->serialize(ar);
+        }
+
+        reset_with_state_variables(_output_v);
+        process_model(t, false, false);
+        _output->update(_output_k, t);
     }
-    const double* data = state_variables.data();
+}
+
+auto SimulatorBase::derivatives(double t, const Array& state_variables) -> const Array&
+{
+    pooya_trace("t: " + std::to_string(t));
+
+    reset_with_state_variables(state_variables);
+    process_model(t, false, false);
+
+    const std::size_t num_scalar_states = scalar_state_signals_.size();
+#if defined(POOYA_DEBUG)
     for (auto& sig : scalar_state_signals_)
     {
-        sig->set_value(*data);
-        data++;
+        pooya_verify(sig->deriv_signal()->assigned(),
+                     sig->deriv_signal()->name().str() + ": attempting to access an unassigned value!");
+    }
+#endif // defined(POOYA_DEBUG)
+    if (_derivs_contiguous)
+    {
+        _state_variable_derivs.head(num_scalar_states) = _arena.segment(num_scalar_states, num_scalar_states);
+    }
+    else
+    {
+        for (std::size_t k = 0; k < num_scalar_states; k++)
+        {
+            _state_variable_derivs[k] = _arena[_deriv_offsets[k]];
+        }
     }
+    double* data = _state_variable_derivs.data() + num_scalar_states;
 #ifdef POOYA_ARRAY_SIGNAL
+    for (auto& sig : array_state_signals_)
+    {
+        auto* deriv_sig                            = sig->deriv_signal();
+        Eigen::Map<Array>(data, deriv_sig->size()) = deriv_sig->get_value();
+        data += deriv_sig->size();
+    }
+#endif // POOYA_ARRAY_SIGNAL
+
+    return _state_variable_derivs;
+}
+
+Eigen::SparseMatrix<double> SimulatorBase::compute_jacobian(double t, const Array& state_variables, const Array& derivs)
+{
+    pooya_trace("t: " + std::to_string(t));
+    pooya_verify(_initialized, "The simulator is not initialized!");
+    pooya_verify(static_cast<std::size_t>(state_variables.size()) == _jac_pattern.size(),
+                 "Incorrect state variables size!");
+
+    auto f = [this](double t, const Array& v) -> const Array& { return derivatives(t, v); };
+
+    // derivs may be the storage derivatives() returns, which the evaluations overwrite
+    const Array fv                = derivs;
+    Eigen::SparseMatrix<double> J = _jac_pattern.pattern();
+    Array floor                   = Array::Ones(state_variables.size());
+    Array work(state_variables.size());
+    _jac_pattern.evaluate(f, t, state_variables, fv, floor, work, J);
+
+    return J;
+}
+
+Eigen::SparseMatrix<double> SimulatorBase::compute_jacobian(double t, const Array& state_variables)
+{
+    pooya_trace("t: " + std::to_string(t));
+    return compute_jacobian(t, state_variables, derivatives(t, state_variables));
+}
+
+void SimulatorBase::reset_with_state_variables(const Array& state_variables)
+{
+    pooya_trace0;
+    clear_signals();
+
+    const std::size_t num_scalar_states = scalar_state_signals_.size();
+    _arena.head(num_scalar_states)      = state_variables.head(num_scalar_states);
+    for (auto& sig : scalar_state_signals_)
+    {
+        sig->set_assigned();
+    }
+#ifdef POOYA_ARRAY_SIGNAL
+    const double* data = state_variables.data() + num_scalar_states;
     for (auto& sig : array_state_signals_)
     {
         sig->set_value(Eigen::Map<const Array>(data, sig->size()));
@@ -265,17 +1177,128 @@ void SimulatorBase::reset_with_state_variables(const Array& state_variables)
 #endif // POOYA_ARRAY_SIGNAL
 }
 
+void SimulatorBase::zero_crossings(double t, const Array& state_variables, Array& values)
+{
+    pooya_trace("t: " + std::to_string(t));
+
+    reset_with_state_variables(state_variables);
+    process_model(t, false, false);
+
+    double* data = values.data();
+    for (const auto* block : _zc_blocks)
+    {
+        block->zero_crossings(t, data);
+        data += block->num_zero_crossings();
+    }
+}
+
+namespace
+{
+
+// the fraction of the interval from the end where the first of the crossing functions is estimated to be zero, or a
+// negative value if none of them changes sign
+double crossing(const Array& a, const Array& b)
+{
+    double frac = -1;
+    for (Eigen::Index k = 0; k < a.size(); k++)
+    {
+        if (((a[k] < 0) && (b[k] >= 0)) || ((a[k] > 0) && (b[k] <= 0)))
+        {
+            frac = std::max(frac, b[k] / (b[k] - a[k]));
+        }
+    }
+    return frac;
+}
+
+} // namespace
+
+bool SimulatorBase::locate_event(double t1, const Array& v1, double& t2, Array& v2)
+{
+    pooya_trace("t1: " + std::to_string(t1));
+
+    if (!_zc_valid || (t1 != _zc_t) || !(v1 == _zc_v).all())
+    {
+        zero_crossings(t1, v1, _zc_a);
+    }
+    zero_crossings(t2, v2, _zc_b);
+
+    double frac = crossing(_zc_a, _zc_b);
+    if (frac >= 0)
+    {
+        // the Illinois variant of regula falsi: bisect if the same end is kept twice in a row
+        const double tol = std::max(1e-10 * (t2 - t1), 4 * std::numeric_limits<double>::epsilon() * std::abs(t2));
+        double ta        = t1;
+        double tb        = t2;
+        int kept{0};           // positive if the start is kept, negative if the end is
+        Archive stepper_state; // the stepper at the end of the step, restored after probing it
+        bool probed{false};
+        for (int n = 0; (n < 100) && (tb - ta > tol); n++)
+        {
+            double tm = (std::abs(kept) < 2) ? tb - frac * (tb - ta) : (ta + tb) / 2;
+            tm        = std::min(std::max(tm, ta + tol / 2), tb - tol / 2);
+
+            if (!_stepper->interpolate(tm, _zc_vm))
+            {
+                // the steps within this step only probe it, they must not change the error history of the stepper
+                if (!probed)
+                {
+                    _stepper->serialize(stepper_state);
+                    probed = true;
+                }
+                double new_h;
+                _stepper->step_model(*this, t1, v1, tm, _zc_vm, new_h);
+            }
+            zero_crossings(tm, _zc_vm, _zc_m);
+
+            if (const double f = crossing(_zc_a, _zc_m); f >= 0)
+            {
+                tb   = tm;
+                v2   = _zc_vm;
+                frac = f;
+                _zc_b.swap(_zc_m);
+                kept = (kept > 0) ? kept + 1 : 1;
+            }
+            else
+            {
+                ta   = tm;
+                frac = crossing(_zc_m, _zc_b);
+                _zc_a.swap(_zc_m);
+                kept = (kept < 0) ? kept - 1 : -1;
+            }
+        }
+        t2 = tb;
+
+        if (probed)
+        {
+            Archive ar(stepper_state.blob());
+            _stepper->serialize(ar);
+        }
+    }
+
+    // the end of this step is the start of the next one
+    _zc_a.swap(_zc_b);
+    _zc_v     = v2;
+    _zc_t     = t2;
+    _zc_valid = true;
+
+    return frac >= 0;
+}
+
 void SimulatorBase::get_state_variables(Array& state_variables)
 {
     pooya_trace0;
     pooya_debug_verify(state_variables.size() == _state_variables.size(), "Incorrect output array size!");
-    double* data = state_variables.data();
+
+    const std::size_t num_scalar_states = scalar_state_signals_.size();
+#if defined(POOYA_DEBUG)
     for (auto& sig : scalar_state_signals_)
     {
-        *data = sig->get_value();
-        data++;
+        pooya_verify(sig->assigned(), sig->name().str() + ": attempting to access an unassigned value!");
     }
+#endif // defined(POOYA_DEBUG)
+    state_variables.head(num_scalar_states) = _arena.head(num_scalar_states);
 #ifdef POOYA_ARRAY_SIGNAL
+    double* data = state_variables.data() + num_scalar_states;
     for (auto& sig : array_state_signals_)
     {
         Eigen::Map<Array>(data, sig->size()) = sig->get_value();
@@ -18,10 +18,19 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef __POOYA_SOLVER_SIMULATOR_BASE_HPP__
 #define __POOYA_SOLVER_SIMULATOR_BASE_HPP__
 
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <memory>
+#include <sys/types.h>
+#include <unordered_map>
 #include <vector>
 
+#include "Eigen/SparseCore"
+
+#include "algebraic_loop.hpp"
+#include "jacobian_pattern.hpp"
+#include "src/block/sample_time.hpp"
 #include "src/signal/array.hpp"
 #include "stepper_base.hpp"
 
@@ -32,6 +41,8 @@ class ValueSignalImpl;
 class ScalarSignalImpl;
 class ArraySignalImpl;
 class Block;
+class History;
+class Leaf;
 
 class SimulatorBase
 {
@@ -40,29 +51,152 @@ public:
 
     explicit SimulatorBase(Block& model, InputCallback inputs_cb = nullptr, StepperBase* stepper = nullptr);
     SimulatorBase(const SimulatorBase&) = delete; // no copy constructor
-    virtual ~SimulatorBase()            = default;
+    virtual ~SimulatorBase();
 
     virtual void init(double t0 = 0.0);
     virtual void run(double t, double min_time_step = 1e-3, double max_time_step = 1);
 
+    // Runs the simulation from t0, the current time, and updates the rows of the history at t0 + k * dt up to t1. An
+    // adaptive stepper takes its own steps, which are not cut short to land on the output times, and the rows that fall
+    // within a step are filled by evaluating the model at the state variables the stepper interpolates (see
+    // StepperBase::interpolate()). Any other stepper lands on every output time, as with calling run() for each.
+    void run(History& history, double t0, double t1, double dt, double min_time_step = 1e-3, double max_time_step = 1);
+
+    // evaluates the model with the given state variables and returns the derivatives of the state variables
+    // called by the steppers during a step
+    auto derivatives(double t, const Array& state_variables) -> const Array&;
+
+    // the sparsity pattern of the Jacobian of the derivatives with respect to the state variables, as implied by the
+    // signal links of the leaves (see BlockGraph), available after init(). The rows of the derivatives that depend on a
+    // signal no leaf outputs, e.g. one the input callback assigns, are dense.
+    const JacobianPattern& jacobian_pattern() const { return _jac_pattern; }
+
+    // approximates the Jacobian of the derivatives with respect to the state variables with one evaluation of the model
+    // per color of jacobian_pattern(), derivs are the derivatives at (t, state_variables)
+    // the model is left evaluated with perturbed state variables
+    Eigen::SparseMatrix<double> compute_jacobian(double t, const Array& state_variables, const Array& derivs);
+    Eigen::SparseMatrix<double> compute_jacobian(double t, const Array& state_variables);
+
+    // the leaves with a constant sample time are evaluated once and held afterwards, as are the time-only leaves at a
+    // given time, this has them evaluated again at the next evaluation of the model, e.g. after their parameters are
+    // changed
+    void parameters_changed();
+
+    // A binary image of the state of the simulation: the time, the state variables, the state the stepper keeps from
+    // one step to the next, the held outputs of the discrete leaves and the internal state of the blocks. Loading it
+    // into an initialized simulator of the same model and the same type of stepper continues the simulation from where
+    // it was saved, the signals are up to date after the next call to run(). Both are checked before any state is
+    // loaded. A call to run() at the time of the checkpoint only updates the signals, e.g. after the parameters are
+    // changed.
+    Archive::Blob save_checkpoint();
+    void load_checkpoint(const Archive::Blob& blob);
+
+    // Branches the simulation into the clones, simulators of other instances of the same model, e.g. to run what-if
+    // scenarios from a common warm-up. The state is captured once and loaded into each clone, which is initialized
+    // first if it is not yet. The clones keep their own models, steppers and input callbacks, their steppers must be of
+    // the same type as the one of this simulator.
+    void fork(const std::vector<SimulatorBase*>& clones);
+
+    // the algebraic loops of the model that are solved as one leaf each, available after init()
+    const std::vector<std::unique_ptr<AlgebraicLoop>>& algebraic_loops() const { return _algebraic_loops; }
+
 protected:
+    // the discrete or constant leaves of one sample time, or the continuous leaves that only depend on time
+    struct RateGroup
+    {
+        SampleTime _sample_time;
+        std::vector<Leaf*> _leaves;
+        std::vector<ValueSignalImpl*> _outputs;
+        bool _evaluated{false};
+        double _t{0};        // the time of the last activation
+        uint64_t _epoch{1};  // the epoch of the outputs
+        bool _active{false}; // whether the last update_rate_groups() activated the leaves
+    };
+
     Block& _model;
     double _t_prev{0};
     InputCallback _inputs_cb;
     std::vector<std::shared_ptr<ValueSignalImpl>> value_signals_;
+    uint64_t _epoch{1}; // the epoch of value_signals_ except the outputs of the rate groups
+    std::vector<RateGroup> _rate_groups;
+    // the index of the rate group of each leaf that is in one
+    std::unordered_map<const Leaf*, std::size_t> _leaf_groups;
+    std::vector<std::shared_ptr<ScalarSignalImpl>> scalar_signals_; // in the arena order
     std::vector<std::shared_ptr<ScalarSignalImpl>> scalar_state_signals_;
 #ifdef POOYA_ARRAY_SIGNAL
     std::vector<std::shared_ptr<ArraySignalImpl>> array_state_signals_;
 #endif // POOYA_ARRAY_SIGNAL
+    // the values of all scalar signals on a cache line boundary, see init_arena()
+    std::unique_ptr<double, decltype(&std::free)> _arena_data{nullptr, &std::free};
+    Eigen::Map<Array, Eigen::Aligned64> _arena{nullptr, 0};
+    std::vector<std::size_t> _deriv_offsets; // arena offsets of the derivatives of scalar states
+    bool _derivs_contiguous{false};          // derivatives are located right after the states in the arena
     Array _state_variables;
     Array _state_variables_orig;
     Array _state_variable_derivs;
+    JacobianPattern _jac_pattern;
+    std::vector<std::unique_ptr<AlgebraicLoop>> _algebraic_loops;
+    std::vector<const Block*> _zc_blocks; // the blocks with zero-crossing functions
+    Array _zc_a;                          // the zero-crossing functions at the start of the step
+    Array _zc_b;                          // the zero-crossing functions at the end of the step
+    Array _zc_m;                          // the zero-crossing functions within the step
+    Array _zc_v;                          // the state variables _zc_a is evaluated with
+    Array _zc_vm;                         // the state variables within the step
+    double _zc_t{0};                      // the time _zc_a is evaluated at
+    bool _zc_valid{false};
+    bool _post_step_changes_outputs{false}; // any block changes its outputs in post_step()
     StepperBase* _stepper{nullptr};
+    double _h_next{0}; // the step size an adaptive stepper chose last, 0 if unknown
     bool _initialized{false};
-
+    bool _loaded{false}; // a checkpoint is loaded and run() is not called since
+
+    // the rows run(history, ...) fills within the steps
+    History* _output{nullptr};
+    double _output_t0{0};
+    double _output_dt{0};
+    uint _output_k{0};    // the next row
+    uint _output_last{0}; // the last row, which is updated at the end of run()
+    Array _output_v;
+
+    void init_arena();
+    void init_jacobian_pattern();
+    void init_rate_groups();
+    void init_algebraic_loops();
+
+    // processes the algebraic loops that are ready to be processed, returns true if any is
+    bool process_algebraic_loops(double t);
+
+    // clears the signals except the outputs of the rate groups, which are only cleared when the groups are activated,
+    // by incrementing the epoch they are bound to
+    void clear_signals();
+
+    // called by process_model() before the leaves are processed, the discrete leaves are activated at their sample
+    // hits in the final evaluation of a step, which calls post_step(), the constant ones once, the time-only ones once
+    // per time, and they are held otherwise
+    void update_rate_groups(double t, bool call_post_step);
+
+    // the end of a step from t1 to t2, cut short at the first sample hit of the discrete leaves after t1
+    double limit_to_sample_hits(double t1, double t2) const;
+
+    // whether the final evaluation at t, which calls post_step(), changed the outputs the model has at t, i.e.
+    // activated the discrete leaves or updated a block like a memory
+    bool changed_in_post_step(double t) const;
+    const RateGroup* rate_group(const Leaf& leaf) const; // the rate group of the leaf, nullptr if it is not in one
     void reset_with_state_variables(const Array& state_variables);
     void get_state_variables(Array& state_variables);
 
+    // evaluates the model and the zero-crossing functions of its blocks
+    void zero_crossings(double t, const Array& state_variables, Array& values);
+
+    // if a zero-crossing function changes sign in the step from (t1, v1) to (t2, v2), moves the end of the step to
+    // right after the first such change, found with the interpolant of the stepper
+    bool locate_event(double t1, const Array& v1, double& t2, Array& v2);
+
+    // updates the rows of the history of run(history, ...) at the output times in the step from (t1, v1) to t2
+    void record_output(double t1, const Array& v1, double t2);
+
+    void serialize(Archive& ar);
+
     virtual void process_model(double t, bool call_pre_step, bool call_post_step) = 0;
 };
 
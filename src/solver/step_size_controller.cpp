@@ -0,0 +1,103 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/helper/trace.hpp"
+#include "src/helper/util.hpp"
+#include "step_size_controller.hpp"
+
+namespace pooya
+{
+
+StepSizeController::StepSizeController(unsigned int order, double abs_tol, double rel_tol)
+    : _alpha(0.85 / order), _beta(0.2 / order) // alpha = 1 / order - 0.75 * beta
+{
+    pooya_verify(order > 0, "the order of the error estimate must be positive!");
+    set_tolerances(abs_tol, rel_tol);
+}
+
+void StepSizeController::set_tolerances(double abs_tol, double rel_tol)
+{
+    set_tolerances(Array::Constant(1, abs_tol), Array::Constant(1, rel_tol));
+}
+
+void StepSizeController::set_tolerances(const Array& abs_tol, const Array& rel_tol)
+{
+    pooya_trace0;
+    pooya_verify((abs_tol >= 0).all() && (rel_tol >= 0).all(), "the tolerances cannot be negative!");
+    _abs_tol = abs_tol;
+    _rel_tol = rel_tol;
+}
+
+void StepSizeController::init(std::size_t num_states)
+{
+    pooya_trace0;
+
+    auto size_tolerance = [&](Array& tol)
+    {
+        if (tol.size() == 1)
+        {
+            tol = Array::Constant(num_states, tol[0]);
+        }
+        pooya_verify(static_cast<std::size_t>(tol.size()) == num_states,
+                     "the number of tolerances does not match the number of state variables!");
+    };
+    size_tolerance(_abs_tol);
+    size_tolerance(_rel_tol);
+
+    _scaled_err.resize(num_states);
+    _err_prev = 1e-4;
+    _rejected = false;
+}
+
+double StepSizeController::error_norm(const Array& err, const Array& v0, const Array& v1)
+{
+    pooya_trace0;
+    if (err.size() == 0)
+    {
+        return 0;
+    }
+
+    if (_abs_tol.size() != err.size())
+    {
+        // the stepper is used without a simulator calling init
+        init(err.size());
+    }
+
+    _scaled_err = err / (_abs_tol + _rel_tol * v0.abs().max(v1.abs()));
+    return std::sqrt(_scaled_err.square().mean());
+}
+
+double StepSizeController::next_step(double h, double err)
+{
+    if (err <= 1)
+    {
+        double factor = err > 0 ? _safety * std::pow(err, -_alpha) * std::pow(_err_prev, _beta) : _max_factor;
+        // do not grow the step right after a rejection
+        factor    = std::max(_min_factor, std::min(factor, _rejected ? 1.0 : _max_factor));
+        _err_prev = std::max(err, 1e-4);
+        _rejected = false;
+        return h * factor;
+    }
+
+    _rejected = true;
+    return h * std::max(_min_factor, _safety * std::pow(err, -_alpha));
+}
+
+} // namespace pooya
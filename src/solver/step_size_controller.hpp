@@ -0,0 +1,74 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_STEP_SIZE_CONTROLLER_HPP__
+#define __POOYA_SOLVER_STEP_SIZE_CONTROLLER_HPP__
+
+#include "src/block/archive.hpp"
+#include "src/signal/array.hpp"
+
+namespace pooya
+{
+
+// A PI step size controller (Gustafsson), as used by DOPRI5 of Hairer and Wanner. The tolerances are either scalars or
+// vectors with one value per state variable. The error of the last accepted step is kept from one step to the next.
+class StepSizeController
+{
+public:
+    // order: the order of the error estimate, e.g. 5 for a 4(5) or 5(4) pair
+    explicit StepSizeController(unsigned int order, double abs_tol = 1e-6, double rel_tol = 1e-3);
+
+    void set_tolerances(double abs_tol, double rel_tol);
+    void set_tolerances(const Array& abs_tol, const Array& rel_tol);
+
+    // sizes the tolerances and the workspace and forgets the history
+    void init(std::size_t num_states);
+
+    // the RMS of err scaled by abs_tol + rel_tol * max(|v0|, |v1|), the step is acceptable if it is not above 1
+    double error_norm(const Array& err, const Array& v0, const Array& v1);
+
+    // returns the size of the next step, or the size of the retry if err is above 1
+    double next_step(double h, double err);
+
+    bool accepted() const { return !_rejected; }
+
+    const Array& abs_tol() const { return _abs_tol; }
+
+    // the history of the controller, for checkpoints
+    void serialize(Archive& ar)
+    {
+        ar(_err_prev);
+        ar(_rejected);
+    }
+
+protected:
+    double _alpha;
+    double _beta;
+    double _safety{0.9};
+    double _min_factor{0.2};
+    double _max_factor{10};
+
+    Array _abs_tol;
+    Array _rel_tol;
+    Array _scaled_err;
+    double _err_prev{1e-4};
+    bool _rejected{false};
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_STEP_SIZE_CONTROLLER_HPP__
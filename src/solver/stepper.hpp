@@ -0,0 +1,51 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_STEPPER_HPP__
+#define __POOYA_SOLVER_STEPPER_HPP__
+
+#include "simulator_base.hpp"
+#include "stepper_base.hpp"
+
+namespace pooya
+{
+
+// Derived implements the stepping algorithm once, as a template over the callback:
+//   template<typename Callback>
+//   void step_impl(Callback& f, double t0, const Array& v0, double t1, Array& v1, double& new_h);
+// so that the derivatives of the simulator are evaluated without going through a StepperCallback.
+template<typename Derived>
+class StepperT : public StepperBase
+{
+public:
+    void step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h) override
+    {
+        pooya_trace0;
+        static_cast<Derived*>(this)->step_impl(callback, t0, v0, t1, v1, new_h);
+    }
+
+    void step_model(SimulatorBase& sim, double t0, const Array& v0, double t1, Array& v1, double& new_h) override
+    {
+        pooya_trace0;
+        auto f = [&sim](double t, const Array& v) -> const Array& { return sim.derivatives(t, v); };
+        static_cast<Derived*>(this)->step_impl(f, t0, v0, t1, v1, new_h);
+    }
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_STEPPER_HPP__
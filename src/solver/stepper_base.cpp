@@ -1,5 +1,5 @@
 /*
-Copyright 2024 Mojtaba (Moji) Fathi
+Copyright 2025 Mojtaba (Moji) Fathi
 
  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
 documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
@@ -15,19 +15,16 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER I
 OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-#include "euler.hpp"
-#include "src/helper/trace.hpp"
+#include "simulator_base.hpp"
+#include "stepper_base.hpp"
 
 namespace pooya
 {
 
-void Euler::step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h)
+void StepperBase::step_model(SimulatorBase& sim, double t0, const Array& v0, double t1, Array& v1, double& new_h)
 {
     pooya_trace0;
-    _callback = callback;
-    double h = new_h = t1 - t0;
-
-    v1 = v0 + h * f(t0, v0);
+    step([&sim](double t, const Array& v) -> const Array& { return sim.derivatives(t, v); }, t0, v0, t1, v1, new_h);
 }
 
 } // namespace pooya
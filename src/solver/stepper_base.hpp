@@ -20,30 +20,53 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include <functional>
 
+#include "src/block/archive.hpp"
 #include "src/helper/trace.hpp"
 #include "src/signal/array.hpp"
 
 namespace pooya
 {
 
+class JacobianPattern;
+class SimulatorBase;
+
 class StepperBase
 {
 public:
     using StepperCallback = std::function<const Array&(double, const Array&)>;
 
-protected:
-    StepperCallback _callback;
+    StepperBase() = default;
 
-    auto f(double t, const Array& v) -> const Array&
-    {
-        pooya_trace0;
-        return _callback(t, v);
-    }
+    // called by the simulators once the number of state variables is known, e.g. to allocate the workspaces
+    virtual void init(std::size_t /*num_states*/) {}
 
-public:
-    StepperBase() = default;
+    // called by the simulators after init() with the sparsity pattern of the Jacobian of the model
+    virtual void set_jacobian_pattern(const JacobianPattern* /*pattern*/) {}
 
     virtual void step(StepperCallback callback, double t0, const Array& v0, double t1, Array& v1, double& new_h) = 0;
+
+    // called by the simulators, the default implementation wraps sim.derivatives() in a StepperCallback
+    virtual void step_model(SimulatorBase& sim, double t0, const Array& v0, double t1, Array& v1, double& new_h);
+
+    // an adaptive stepper chooses its own step size, which the simulators keep from one call of run() to the next
+    virtual bool adaptive() const { return false; }
+
+    // whether the last step of size h is accepted, given the new_h it returned
+    virtual bool accepted(double h, double new_h) const { return new_h >= h; }
+
+    // whether the last step produced no solution at all, e.g. the Newton iteration of an implicit stepper diverged,
+    // which the simulators never accept, not even at the minimum step size
+    virtual bool failed() const { return false; }
+
+    // called by the simulators when the final evaluation of a step changed the derivatives the model has at its end,
+    // e.g. activated a discrete leaf, so that they are not reused by the next step
+    virtual void model_changed() {}
+
+    // the solution at t within the last step, returns false if the stepper has no interpolant
+    virtual bool interpolate(double /*t*/, Array& /*v*/) const { return false; }
+
+    // writes the state the stepper keeps from one step to the next to a checkpoint or reads it back from one
+    virtual void serialize(Archive& /*ar*/) {}
 };
 
 } // namespace pooya
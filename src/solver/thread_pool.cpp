@@ -0,0 +1,148 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "thread_pool.hpp"
+#include "src/helper/trace.hpp"
+#include "src/helper/util.hpp"
+
+namespace pooya
+{
+
+ThreadPool::ThreadPool(std::size_t num_threads)
+{
+    pooya_trace("num_threads: " + std::to_string(num_threads));
+    pooya_verify(num_threads > 0, "at least one thread is required!");
+
+    _workers.reserve(num_threads - 1);
+    for (std::size_t k = 1; k < num_threads; k++)
+    {
+        _workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t n, std::size_t chunk_size, const RangeCallback& cb)
+{
+    pooya_trace0;
+    pooya_debug_verify0(chunk_size > 0);
+
+    if (_workers.empty() || n <= chunk_size)
+    {
+        cb(0, n);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cb         = &cb;
+        _n          = n;
+        _chunk_size = chunk_size;
+        _next.store(0, std::memory_order_relaxed);
+        _num_busy.store(_workers.size(), std::memory_order_relaxed);
+        _generation++;
+    }
+    _cv.notify_all();
+
+    run_chunks();
+
+    // the barrier, the workers are about to finish their last chunks, so spinning is cheaper than sleeping
+    while (_num_busy.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+
+    _cb = nullptr;
+
+    if (_exception)
+    {
+        auto exception = _exception;
+        _exception     = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::worker_loop()
+{
+    // number of times a worker yields before it goes to sleep, the levels of a model come in quick succession
+    constexpr int spin_count = 1000;
+
+    std::size_t generation = 0;
+    for (;;)
+    {
+        for (int k = 0; (k < spin_count) && (_generation.load() == generation) && !_stop.load(); k++)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [&]() { return _stop || (_generation != generation); });
+            if (_stop)
+            {
+                return;
+            }
+            generation = _generation;
+        }
+
+        run_chunks();
+        _num_busy.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void ThreadPool::run_chunks()
+{
+    for (;;)
+    {
+        std::size_t begin = _next.fetch_add(_chunk_size, std::memory_order_relaxed);
+        if (begin >= _n)
+        {
+            return;
+        }
+
+        try
+        {
+            (*_cb)(begin, std::min(begin + _chunk_size, _n));
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_exception_mutex);
+            if (!_exception)
+            {
+                _exception = std::current_exception();
+            }
+            // skip the remaining chunks
+            _next.store(_n, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace pooya
@@ -0,0 +1,75 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __POOYA_SOLVER_THREAD_POOL_HPP__
+#define __POOYA_SOLVER_THREAD_POOL_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pooya
+{
+
+// A pool of worker threads that run the chunks of a loop together with the calling thread. The chunks are claimed
+// dynamically so that the threads that finish early take over the remaining work. parallel_for returns when all the
+// chunks are processed, i.e. it is a barrier.
+class ThreadPool
+{
+public:
+    using RangeCallback = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // num_threads includes the calling thread
+    explicit ThreadPool(std::size_t num_threads);
+    ThreadPool(const ThreadPool&) = delete; // no copy constructor
+    ~ThreadPool();
+
+    std::size_t num_threads() const { return _workers.size() + 1; }
+
+    // calls cb for the consecutive ranges of [0, n) with at most chunk_size elements each
+    // an exception thrown by cb is rethrown on the calling thread
+    void parallel_for(std::size_t n, std::size_t chunk_size, const RangeCallback& cb);
+
+protected:
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::atomic<std::size_t> _generation{0};
+    std::atomic<bool> _stop{false};
+
+    // the current loop
+    const RangeCallback* _cb{nullptr};
+    std::size_t _n{0};
+    std::size_t _chunk_size{1};
+    std::atomic<std::size_t> _next{0};
+    std::atomic<std::size_t> _num_busy{0};
+    std::exception_ptr _exception;
+    std::mutex _exception_mutex;
+
+    void worker_loop();
+    void run_chunks();
+};
+
+} // namespace pooya
+
+#endif // __POOYA_SOLVER_THREAD_POOL_HPP__
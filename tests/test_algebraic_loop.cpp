@@ -0,0 +1,171 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/gain.hpp"
+#include "src/block/extra/siso_function.hpp"
+#include "src/block/extra/subtract.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/block_graph.hpp"
+#include "src/solver/fast_simulator.hpp"
+#include "src/solver/rk4.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestAlgebraicLoop : public testing::Test
+{
+public:
+    TestAlgebraicLoop()
+    {
+        //
+    }
+};
+
+// x' = -y, y = x - 0.5 * y, i.e. x = exp(-2 * t / 3)
+class LinearLoop : public pooya::Submodel
+{
+protected:
+    pooya::Integrator _integ{1.0, this};
+    pooya::Subtract _sub{this};
+    pooya::Gain _half{0.5, this};
+    pooya::Gain _neg{-1.0, this};
+
+public:
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _y{"y"};
+    pooya::ScalarSignal _h{"h"};
+    pooya::ScalarSignal _xd{"xd"};
+
+    LinearLoop()
+    {
+        _integ.connect({_xd}, {_x});
+        _sub.connect({_x, _h}, {_y});
+        _half.connect({_y}, {_h});
+        _neg.connect({_y}, {_xd});
+    }
+};
+
+// y = cos(y)
+class NonlinearLoop : public pooya::Submodel
+{
+protected:
+    pooya::SISOFunction _cos{[](double /*t*/, double y) -> double { return std::cos(y); }, this};
+    pooya::Gain _copy{1.0, this};
+
+public:
+    pooya::ScalarSignal _c{"c"};
+    pooya::ScalarSignal _y{"y"};
+
+    NonlinearLoop()
+    {
+        _cos.connect({_y}, {_c});
+        _copy.connect({_c}, {_y});
+    }
+};
+
+TEST_F(TestAlgebraicLoop, BlockGraph)
+{
+    LinearLoop model;
+    pooya::BlockGraph graph(model);
+
+    std::vector<std::size_t> order;
+    EXPECT_FALSE(graph.topological_order(order));
+
+    std::vector<std::vector<std::size_t>> loops;
+    graph.algebraic_loops(loops);
+    ASSERT_EQ(1, loops.size());
+    EXPECT_EQ(2, loops[0].size());
+
+    // with the loop condensed into one node, the leaves of the model are ordered
+    const std::size_t num_leaves = graph.leaves().size();
+    std::vector<std::size_t> node(num_leaves, num_leaves);
+    std::size_t num_nodes{0};
+    for (auto k : loops[0])
+    {
+        node[k] = 0;
+    }
+    num_nodes++;
+    for (auto& n : node)
+    {
+        if (n == num_leaves)
+        {
+            n = num_nodes++;
+        }
+    }
+    EXPECT_TRUE(graph.topological_order(node, num_nodes, order));
+    EXPECT_EQ(num_leaves - 1, order.size());
+}
+
+template<typename Simulator, typename... Args>
+void run_linear_loop(Args... args)
+{
+    // model setup
+    LinearLoop model;
+
+    // simulator setup
+    pooya::Rk4 stepper;
+    Simulator sim(model, nullptr, &stepper, args...);
+
+    sim.init(0.0);
+    ASSERT_EQ(1, sim.algebraic_loops().size());
+    EXPECT_EQ(1, sim.algebraic_loops()[0]->torn_signals().size());
+
+    for (int k = 1; k <= 100; k++)
+    {
+        sim.run(0.01 * k);
+    }
+
+    EXPECT_NEAR(std::exp(-2.0 / 3), model._x, 1e-8);
+    EXPECT_NEAR(2.0 / 3 * model._x, model._y, 1e-8);
+}
+
+TEST_F(TestAlgebraicLoop, Linear)
+{
+    run_linear_loop<pooya::Simulator>();
+    run_linear_loop<pooya::Simulator>(true); // the loop is a node of the order of the leaves
+    run_linear_loop<pooya::FastSimulator>();
+}
+
+template<typename Simulator, typename... Args>
+void run_nonlinear_loop(Args... args)
+{
+    // model setup
+    NonlinearLoop model;
+
+    // simulator setup
+    Simulator sim(model, nullptr, nullptr, args...);
+
+    sim.init(0.0);
+    EXPECT_NEAR(0.7390851332151607, model._y, 1e-9);
+    EXPECT_NEAR(std::cos(model._y), model._c, 1e-9);
+
+    // the solution is the initial guess of the next evaluation
+    const auto num_evaluations = sim.algebraic_loops()[0]->num_evaluations();
+    sim.run(1.0);
+    EXPECT_EQ(num_evaluations + 1, sim.algebraic_loops()[0]->num_evaluations());
+}
+
+TEST_F(TestAlgebraicLoop, Nonlinear)
+{
+    run_nonlinear_loop<pooya::Simulator>();
+    run_nonlinear_loop<pooya::Simulator>(true);
+    run_nonlinear_loop<pooya::FastSimulator>();
+}
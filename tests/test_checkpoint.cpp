@@ -0,0 +1,200 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/const.hpp"
+#include "src/block/extra/delay.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/dopri54.hpp"
+#include "src/solver/fast_simulator.hpp"
+#include "src/solver/rk4.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestCheckpoint : public testing::Test
+{
+public:
+    TestCheckpoint()
+    {
+        //
+    }
+};
+
+// x'' = -x, with y(t) = x(t - 0.3)
+class DelayedMassSpring : public pooya::Submodel
+{
+protected:
+    pooya::Integrator _integ1{0.0, this};
+    pooya::Integrator _integ2{1.0, this};
+    pooya::Gain _gain{-1.0, this};
+    pooya::Const _delay_time{0.3, this};
+    pooya::Const _initial{0.0, this};
+    pooya::Delay _delay{1.0, this};
+
+public:
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _xdd{"xdd"};
+    pooya::ScalarSignal _td{"td"};
+    pooya::ScalarSignal _y0{"y0"};
+    pooya::ScalarSignal _y{"y"};
+
+    DelayedMassSpring()
+    {
+        _integ1.connect({_xdd}, {_xd});
+        _integ2.connect({_xd}, {_x});
+        _gain.connect({_x}, {_xdd});
+        _delay_time.connect({}, {_td});
+        _initial.connect({}, {_y0});
+        _delay.connect({{"delay", _td}, {"in", _x}, {"initial", _y0}}, {_y});
+    }
+};
+
+TEST_F(TestCheckpoint, Resume)
+{
+    // run to the end without interruption, saving a checkpoint half way
+    DelayedMassSpring model1;
+    pooya::DoPri54 stepper1;
+    pooya::Simulator sim1(model1, nullptr, &stepper1);
+    sim1.init(0.0);
+
+    pooya::Archive::Blob blob;
+    for (int k = 1; k <= 20; k++)
+    {
+        sim1.run(0.1 * k);
+        if (k == 10)
+        {
+            blob = sim1.save_checkpoint();
+        }
+    }
+
+    // resume a fresh simulation of the same model from the checkpoint
+    DelayedMassSpring model2;
+    pooya::DoPri54 stepper2;
+    pooya::Simulator sim2(model2, nullptr, &stepper2);
+    sim2.init(0.0);
+    sim2.load_checkpoint(blob);
+    for (int k = 11; k <= 20; k++)
+    {
+        sim2.run(0.1 * k);
+    }
+
+    // verify the results
+    EXPECT_DOUBLE_EQ(model1._x, model2._x);
+    EXPECT_DOUBLE_EQ(model1._xd, model2._xd);
+    EXPECT_DOUBLE_EQ(model1._y, model2._y);
+    EXPECT_NEAR(std::cos(1.7), model2._y, 1e-4);
+}
+
+TEST_F(TestCheckpoint, ModelMismatch)
+{
+    DelayedMassSpring model1;
+    pooya::DoPri54 stepper1;
+    pooya::Simulator sim1(model1, nullptr, &stepper1);
+    sim1.init(0.0);
+    sim1.run(0.1);
+    const auto blob = sim1.save_checkpoint();
+
+    // a checkpoint does not load into a different model
+    pooya::Gain gain(2.0);
+    pooya::ScalarSignal s_x;
+    pooya::ScalarSignal s_y;
+    gain.connect({s_x}, {s_y});
+    pooya::Simulator sim2(gain, [&](pooya::Block&, double t) -> void { s_x = t; });
+    sim2.init(0.0);
+    EXPECT_THROW(sim2.load_checkpoint(blob), std::runtime_error);
+}
+
+TEST_F(TestCheckpoint, StepperMismatch)
+{
+    DelayedMassSpring model1;
+    pooya::DoPri54 stepper1;
+    pooya::Simulator sim1(model1, nullptr, &stepper1);
+    sim1.init(0.0);
+    sim1.run(0.5);
+
+    // a checkpoint does not load into a simulator with another type of stepper, which is left as it was
+    DelayedMassSpring model2;
+    pooya::Rk4 stepper2;
+    pooya::Simulator sim2(model2, nullptr, &stepper2);
+    sim2.init(0.0);
+    sim2.run(0.1);
+    const auto blob = sim2.save_checkpoint();
+    EXPECT_THROW(sim1.fork({&sim2}), std::runtime_error);
+    EXPECT_EQ(blob, sim2.save_checkpoint());
+}
+
+TEST_F(TestCheckpoint, ArraySizeMismatch)
+{
+    pooya::Archive ar1;
+    pooya::Array3 a1{1.0, 2.0, 3.0};
+    ar1(a1);
+
+    // an array of another size does not load into a fixed-size one
+    pooya::Archive ar2(ar1.blob());
+    pooya::Array2 a2{0.0, 0.0};
+    EXPECT_THROW(ar2(a2), std::runtime_error);
+
+    // it does into a dynamic one
+    pooya::Archive ar3(ar1.blob());
+    pooya::Array a3;
+    ar3(a3);
+    EXPECT_TRUE(ar3.at_end());
+    EXPECT_EQ(3, a3.size());
+}
+
+TEST_F(TestCheckpoint, Fork)
+{
+    // warm up
+    DelayedMassSpring model;
+    pooya::DoPri54 stepper;
+    pooya::Simulator sim(model, nullptr, &stepper);
+    sim.init(0.0);
+    for (int k = 1; k <= 10; k++)
+    {
+        sim.run(0.1 * k);
+    }
+
+    // branch into other instances of the model
+    DelayedMassSpring model1;
+    pooya::DoPri54 stepper1;
+    pooya::Simulator sim1(model1, nullptr, &stepper1);
+    DelayedMassSpring model2;
+    pooya::DoPri54 stepper2;
+    pooya::FastSimulator sim2(model2, nullptr, &stepper2);
+    sim.fork({&sim1, &sim2});
+
+    // the branches continue where the simulation was forked
+    for (int k = 11; k <= 20; k++)
+    {
+        sim.run(0.1 * k);
+        sim1.run(0.1 * k);
+        sim2.run(0.1 * k);
+    }
+
+    // verify the results
+    EXPECT_DOUBLE_EQ(model._x, model1._x);
+    EXPECT_DOUBLE_EQ(model._y, model1._y);
+    EXPECT_DOUBLE_EQ(model._x, model2._x);
+    EXPECT_DOUBLE_EQ(model._y, model2._y);
+}
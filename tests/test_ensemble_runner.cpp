@@ -0,0 +1,331 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/add.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/array_signal.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/ensemble_runner.hpp"
+#include "src/solver/rk4.hpp"
+#include "src/solver/rkf45.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestEnsembleRunner : public testing::Test
+{
+public:
+    TestEnsembleRunner()
+    {
+        //
+    }
+};
+
+// a gain whose gain is a parameter of the samples
+template<typename T>
+class ParameterGainT : public pooya::GainT<T, double>
+{
+public:
+    using Base = pooya::GainT<T, double>;
+
+    ParameterGainT(double k, pooya::Submodel* parent) : Base(k, parent) {}
+
+    void set_gain(double k) { Base::_k = k; }
+};
+
+// an integrator whose initial value is a parameter of the samples
+class ParameterIntegrator : public pooya::Integrator
+{
+public:
+    ParameterIntegrator(double ic, pooya::Submodel* parent) : pooya::Integrator(ic, parent) {}
+
+    void set_value(double value) { _value = value; }
+};
+
+// x'' = -x - c * x' and v' = -a * v
+class DampedModel : public pooya::Submodel
+{
+protected:
+    pooya::Integrator _integ_xd;
+    ParameterIntegrator _integ_x;
+    pooya::Gain _gain_k{-1.0, this};
+    ParameterGainT<double> _gain_c;
+    pooya::Add _add{0.0, this};
+    pooya::IntegratorA _integ_v;
+    ParameterGainT<pooya::Array> _gain_a;
+
+    pooya::ScalarSignal _s10;
+    pooya::ScalarSignal _s20;
+
+public:
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _xdd{"xdd"};
+    pooya::ArraySignal _v{2, "v"};
+    pooya::ArraySignal _vd{2, "vd"};
+
+    // params: c, x0, a
+    explicit DampedModel(const pooya::Array& params)
+        : _integ_xd(0.0, this), _integ_x(params[1], this), _gain_c(-params[0], this),
+          _integ_v(pooya::Array2{1.0, 2.0}, this), _gain_a(-params[2], this)
+    {
+        _integ_xd.connect({_xdd}, {_xd});
+        _integ_x.connect({_xd}, {_x});
+        _gain_k.connect({_x}, {_s10});
+        _gain_c.connect({_xd}, {_s20});
+        _add.connect({_s10, _s20}, {_xdd});
+        _integ_v.connect({_vd}, {_v});
+        _gain_a.connect({_v}, {_vd});
+    }
+
+    void set_parameters(const pooya::Array& params)
+    {
+        _gain_c.set_gain(-params[0]);
+        _integ_x.set_value(params[1]);
+        _gain_a.set_gain(-params[2]);
+    }
+};
+
+pooya::Array sample_parameters(std::size_t sample)
+{
+    return pooya::Array3{0.1 + 0.05 * sample, 0.5 + 0.1 * sample, 0.2 + 0.1 * sample};
+}
+
+class Instance : public pooya::EnsembleRunner::Instance
+{
+public:
+    DampedModel _model;
+    pooya::Rk4 _stepper;
+    pooya::Simulator _sim{_model, nullptr, &_stepper};
+
+    explicit Instance(const pooya::Array& params = sample_parameters(0)) : _model(params) {}
+
+    pooya::SimulatorBase& simulator() override { return _sim; }
+
+    void reset(const pooya::Array& params) override
+    {
+        if (params[0] < 0)
+        {
+            throw std::runtime_error("invalid damping!");
+        }
+        _model.set_parameters(params);
+    }
+};
+
+void track_all(pooya::EnsembleRunner::Instance& instance, pooya::History& history)
+{
+    // not in the order of declaration
+    auto& model = static_cast<Instance&>(instance)._model;
+    history.track(model._v);
+    history.track(model._xd);
+    history.track(model._x);
+}
+
+TEST_F(TestEnsembleRunner, MatchesSerialRuns)
+{
+    // test parameters
+    const std::size_t num_samples = 6;
+    const double t0               = 0.0;
+    const double t1               = 2.0;
+    const double dt               = 0.1;
+
+    pooya::EnsembleRunner runner([]() { return std::make_unique<Instance>(); }, sample_parameters, track_all, 4);
+    runner.run(num_samples, t0, t1, dt);
+
+    // the columns are in the order of tracking, the array elements one after another
+    EXPECT_EQ(std::vector<std::string>({"v[0]", "v[1]", "xd", "x"}), runner.names());
+    ASSERT_EQ(num_samples, runner.num_samples());
+    ASSERT_EQ(21, runner.time().size());
+
+    // each sample matches a serial run of the same parameters in its own column
+    for (std::size_t s = 0; s < num_samples; s++)
+    {
+        const auto params = sample_parameters(s);
+        EXPECT_TRUE((runner.parameters()[s] == params).all());
+
+        Instance instance(params);
+        for (Eigen::Index k = 0; k < runner.time().size(); k++)
+        {
+            const double t = t0 + k * dt;
+            instance._sim.run(t);
+            EXPECT_DOUBLE_EQ(t, runner.time()[k]);
+            EXPECT_DOUBLE_EQ(instance._model._v[0], runner["v[0]"](k, s));
+            EXPECT_DOUBLE_EQ(instance._model._v[1], runner["v[1]"](k, s));
+            EXPECT_DOUBLE_EQ(instance._model._xd, runner["xd"](k, s));
+            EXPECT_DOUBLE_EQ(instance._model._x, runner["x"](k, s));
+        }
+    }
+    EXPECT_TRUE((runner[0].array() == runner["v[0]"].array()).all());
+    EXPECT_THROW(runner["y"], std::runtime_error);
+}
+
+TEST_F(TestEnsembleRunner, NumberOfThreads)
+{
+    // test parameters
+    const std::size_t num_samples = 12;
+
+    // the instances are reused across the samples, the results do not depend on which one runs a sample
+    auto run = [&](std::size_t num_threads, int& num_instances) -> std::vector<Eigen::MatrixXd>
+    {
+        std::atomic<int> count{0};
+        pooya::EnsembleRunner runner(
+            [&count]()
+            {
+                count++;
+                return std::make_unique<Instance>();
+            },
+            sample_parameters, track_all, num_threads);
+        runner.run(num_samples, 0.0, 2.0, 0.1);
+        num_instances = count;
+
+        std::vector<Eigen::MatrixXd> values;
+        for (std::size_t c = 0; c < runner.names().size(); c++)
+        {
+            values.push_back(runner[c]);
+        }
+        return values;
+    };
+
+    int num_instances_1{0};
+    int num_instances_4{0};
+    const auto values_1 = run(1, num_instances_1);
+    const auto values_4 = run(4, num_instances_4);
+
+    EXPECT_EQ(1, num_instances_1);
+    EXPECT_GE(4, num_instances_4);
+    ASSERT_EQ(values_1.size(), values_4.size());
+    for (std::size_t c = 0; c < values_1.size(); c++)
+    {
+        EXPECT_TRUE((values_1[c].array() == values_4[c].array()).all());
+    }
+}
+
+TEST_F(TestEnsembleRunner, SampleThrows)
+{
+    // sample 5 has a negative damping, which the instance rejects
+    auto sampler = [](std::size_t sample) -> pooya::Array
+    {
+        pooya::Array params = sample_parameters(sample);
+        if (sample == 5)
+        {
+            params[0] = -1;
+        }
+        return params;
+    };
+
+    for (std::size_t num_threads : {1, 4})
+    {
+        pooya::EnsembleRunner runner([]() { return std::make_unique<Instance>(); }, sampler, track_all, num_threads);
+        EXPECT_THROW(runner.run(8, 0.0, 1.0, 0.1), std::runtime_error);
+    }
+}
+
+// the x'' = -x - c * x' part of DampedModel for an ensemble in lock step, one element of every signal per member
+class DampedEnsemble : public pooya::Submodel
+{
+protected:
+    pooya::IntegratorA _integ_xd;
+    pooya::IntegratorA _integ_x;
+    pooya::GainA _gain_k{-1.0, this};
+    pooya::GainAA _gain_c;
+    pooya::AddA _add;
+
+    pooya::ArraySignal _s10;
+    pooya::ArraySignal _s20;
+
+public:
+    pooya::ArraySignal _x;
+    pooya::ArraySignal _xd;
+    pooya::ArraySignal _xdd;
+
+    DampedEnsemble(const pooya::Array& c, const pooya::Array& x0)
+        : _integ_xd(pooya::Array::Zero(c.size()), this), _integ_x(x0, this), _gain_c(-c, this),
+          _add(pooya::Array::Zero(c.size()), this), _s10(c.size()), _s20(c.size()), _x(c.size(), "x"),
+          _xd(c.size(), "xd"), _xdd(c.size(), "xdd")
+    {
+        _integ_xd.connect({_xdd}, {_xd});
+        _integ_x.connect({_xd}, {_x});
+        _gain_k.connect({_x}, {_s10});
+        _gain_c.connect({_xd}, {_s20});
+        _add.connect({_s10, _s20}, {_xdd});
+    }
+};
+
+// simulates the members of an ensemble in lock step and one by one and compares the results
+template<typename Stepper>
+void run_lock_step(double dt, double tol)
+{
+    // test parameters
+    const std::size_t num_members = 4;
+
+    pooya::Array c(num_members);
+    pooya::Array x0(num_members);
+    for (std::size_t n = 0; n < num_members; n++)
+    {
+        const auto params = sample_parameters(n);
+        c[n]              = params[0];
+        x0[n]             = params[1];
+    }
+
+    DampedEnsemble ensemble(c, x0);
+    Stepper ensemble_stepper;
+    pooya::Simulator ensemble_sim(ensemble, nullptr, &ensemble_stepper);
+
+    struct Member
+    {
+        DampedModel _model;
+        Stepper _stepper;
+        pooya::Simulator _sim{_model, nullptr, &_stepper};
+
+        explicit Member(const pooya::Array& params) : _model(params) {}
+    };
+    std::vector<std::unique_ptr<Member>> members;
+    for (std::size_t n = 0; n < num_members; n++)
+    {
+        members.push_back(std::make_unique<Member>(sample_parameters(n)));
+    }
+
+    for (int k = 0; k <= 20; k++)
+    {
+        const double t = k * dt;
+        ensemble_sim.run(t);
+        for (std::size_t n = 0; n < num_members; n++)
+        {
+            members[n]->_sim.run(t);
+            EXPECT_NEAR(members[n]->_model._x, ensemble._x[n], tol);
+            EXPECT_NEAR(members[n]->_model._xd, ensemble._xd[n], tol);
+        }
+    }
+}
+
+TEST_F(TestEnsembleRunner, LockStep)
+{
+    // the members take the same steps as they would alone
+    run_lock_step<pooya::Rk4>(0.1, 1e-12);
+
+    // the members share the step size, which is chosen for the least accurate one, so they only agree within the
+    // tolerance of the stepper
+    run_lock_step<pooya::Rkf45>(1, 1e-2);
+}
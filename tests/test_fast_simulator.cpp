@@ -0,0 +1,284 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/add.hpp"
+#include "src/block/extra/const.hpp"
+#include "src/block/extra/divide.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/extra/multiply.hpp"
+#include "src/block/extra/pipe.hpp"
+#include "src/block/extra/subtract.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/fast_simulator.hpp"
+#include "src/solver/rk4.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestFastSimulator : public testing::Test
+{
+public:
+    TestFastSimulator()
+    {
+        //
+    }
+};
+
+// a gain with a custom activation function, which cannot be lowered to an arithmetic instruction
+class OffsetGain : public pooya::Gain
+{
+public:
+    OffsetGain(double k, pooya::Submodel* parent) : pooya::Gain(k, parent) {}
+
+    void activation_function(double /*t*/) override { _s_out = _k * _s_in->get_value() + 1.0; }
+};
+
+TEST_F(TestFastSimulator, ArithmeticBlocks)
+{
+    // test parameters
+    const double x = 3.7;
+
+    // model setup
+    pooya::Submodel model;
+
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_c("c");
+    pooya::ScalarSignal s_gain("gain");
+    pooya::ScalarSignal s_offset_gain("offset_gain");
+    pooya::ScalarSignal s_add("add");
+    pooya::ScalarSignal s_sub("sub");
+    pooya::ScalarSignal s_mul("mul");
+    pooya::ScalarSignal s_div("div");
+    pooya::ScalarSignal s_pipe("pipe");
+
+    pooya::Const c(2.5, &model);
+    pooya::Gain gain(-1.5, &model);
+    OffsetGain offset_gain(3.0, &model);
+    pooya::Add add(0.5, &model);
+    pooya::Subtract sub(&model);
+    pooya::Multiply mul(2.0, &model);
+    pooya::Divide div(&model);
+    pooya::Pipe pipe(&model);
+
+    c.connect({}, {s_c});
+    gain.connect({s_x}, {s_gain});
+    offset_gain.connect({s_gain}, {s_offset_gain});
+    add.connect({s_x, s_c, s_offset_gain}, {s_add});
+    sub.connect({s_add, s_gain}, {s_sub});
+    mul.connect({s_sub, s_c}, {s_mul});
+    div.connect({s_mul, s_x}, {s_div});
+    pipe.connect({s_div}, {s_pipe});
+
+    // simulator setup
+    pooya::FastSimulator sim(model, [&](pooya::Block&, double /*t*/) -> void { s_x = x; });
+
+    // do one step
+    sim.init(0.0);
+
+    // verify the results
+    const double gain_value        = -1.5 * x;
+    const double offset_gain_value = 3.0 * gain_value + 1.0;
+    const double add_value         = 0.5 + x + 2.5 + offset_gain_value;
+    const double sub_value         = add_value - gain_value;
+    const double mul_value         = 2.0 * sub_value * 2.5;
+    EXPECT_DOUBLE_EQ(2.5, s_c);
+    EXPECT_DOUBLE_EQ(gain_value, s_gain);
+    EXPECT_DOUBLE_EQ(offset_gain_value, s_offset_gain);
+    EXPECT_DOUBLE_EQ(add_value, s_add);
+    EXPECT_DOUBLE_EQ(sub_value, s_sub);
+    EXPECT_DOUBLE_EQ(mul_value, s_mul);
+    EXPECT_DOUBLE_EQ(mul_value / x, s_div);
+    EXPECT_DOUBLE_EQ(mul_value / x, s_pipe);
+}
+
+// a gain that is ready to be processed with many others, feeding another one that is only ready after it
+class ChainedGains : public pooya::Submodel
+{
+public:
+    static constexpr int num_gains{40};
+
+    std::vector<std::unique_ptr<pooya::Gain>> _before;
+    OffsetGain _a{2.0, this};
+    pooya::Gain _b{-3.0, this};
+    std::vector<std::unique_ptr<pooya::Gain>> _after;
+    pooya::Integrator _integ{0.0, this};
+
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _ya{"ya"};
+    pooya::ScalarSignal _yb{"yb"};
+    pooya::ScalarSignal _z{"z"};
+    std::vector<pooya::ScalarSignal> _y;
+
+    ChainedGains()
+    {
+        _a.connect({_x}, {_ya});
+        _b.connect({_ya}, {_yb});
+        _integ.connect({_yb}, {_z});
+        for (int k = 0; k < 2 * num_gains; k++)
+        {
+            auto& gains = k < num_gains ? _before : _after;
+            gains.push_back(std::make_unique<pooya::Gain>(k + 1.0, this));
+            _y.emplace_back("y" + std::to_string(k));
+            gains.back()->connect({_x}, {_y.back()});
+        }
+    }
+};
+
+// exposes the levels of the processing order
+class LevelSimulator : public pooya::FastSimulator
+{
+public:
+    using pooya::FastSimulator::FastSimulator;
+
+    // the index of the level of the leaf
+    std::size_t level(const pooya::Leaf& leaf) const
+    {
+        for (std::size_t k = 0; k < _processing_order.size(); k++)
+        {
+            const auto& list = _processing_order[k];
+            if (std::find(list.begin(), list.end(), &leaf) != list.end()) return k;
+        }
+        return _processing_order.size();
+    }
+};
+
+TEST_F(TestFastSimulator, ParallelLevels)
+{
+    auto inputs = [](pooya::Block& model, double t) -> void { static_cast<ChainedGains&>(model)._x = 1.0 + t; };
+
+    // single-threaded reference
+    ChainedGains model1;
+    pooya::Rk4 stepper1;
+    pooya::FastSimulator sim1(model1, inputs, &stepper1);
+    sim1.init(0.0);
+
+    ChainedGains model4;
+    pooya::Rk4 stepper4;
+    LevelSimulator sim4(model4, inputs, &stepper4, 4);
+    sim4.set_min_chunk_size(1);
+    sim4.init(0.0);
+
+    // a leaf is in a later level than its producer
+    EXPECT_LT(sim4.level(model4._a), sim4.level(model4._b));
+
+    for (int k = 1; k <= 20; k++)
+    {
+        sim1.run(0.05 * k);
+        sim4.run(0.05 * k);
+
+        // verify the results
+        EXPECT_DOUBLE_EQ(model1._yb, model4._yb);
+        EXPECT_DOUBLE_EQ(model1._z, model4._z);
+        for (int j = 0; j < 2 * ChainedGains::num_gains; j++)
+        {
+            EXPECT_DOUBLE_EQ(model1._y[j], model4._y[j]);
+        }
+    }
+    EXPECT_DOUBLE_EQ(-3.0 * (2.0 * 2.0 + 1.0), model4._yb);
+}
+
+// a sampled gain, which is lowered as a call because it is held between its sample hits, feeding a wide level of held
+// gains next to a wide level of continuous ones
+class SampledGains : public pooya::Submodel
+{
+public:
+    static constexpr int num_gains{40};
+
+    pooya::Const _one{1.0, this};
+    pooya::Integrator _integ_x{0.0, this};
+    pooya::Submodel _controller{this};
+    pooya::Gain _sample{1.0, &_controller};
+    std::vector<std::unique_ptr<pooya::Gain>> _held;
+    std::vector<std::unique_ptr<pooya::Gain>> _continuous;
+    pooya::Integrator _integ_z{0.0, this};
+
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _y{"y"};
+    pooya::ScalarSignal _z{"z"};
+    std::vector<pooya::ScalarSignal> _w;
+    std::vector<pooya::ScalarSignal> _u;
+
+    SampledGains()
+    {
+        _controller.set_sample_time(pooya::SampleTime::discrete(0.1));
+
+        _one.connect({}, {_xd});
+        _integ_x.connect({_xd}, {_x});
+        _sample.connect({_x}, {_y});
+        for (int k = 0; k < num_gains; k++)
+        {
+            _held.push_back(std::make_unique<pooya::Gain>(k + 1.0, this));
+            _w.emplace_back("w" + std::to_string(k));
+            _held.back()->connect({_y}, {_w.back()});
+
+            _continuous.push_back(std::make_unique<pooya::Gain>(k + 1.0, this));
+            _u.emplace_back("u" + std::to_string(k));
+            _continuous.back()->connect({_x}, {_u.back()});
+        }
+        _integ_z.connect({_w.front()}, {_z});
+    }
+};
+
+template<typename Simulator>
+void run_sampled_gains(SampledGains& model, Simulator& sim)
+{
+    sim.init(0.0);
+    for (int k = 1; k <= 4; k++)
+    {
+        sim.run(0.25 * k);
+    }
+
+    // z integrates the held samples of x
+    EXPECT_NEAR(1.0, model._y, 1e-10);
+    EXPECT_NEAR(0.45, model._z, 1e-10);
+}
+
+TEST_F(TestFastSimulator, HeldCalls)
+{
+    SampledGains model;
+    pooya::Rk4 stepper;
+    pooya::Simulator sim(model, nullptr, &stepper);
+    run_sampled_gains(model, sim);
+
+    SampledGains model1;
+    pooya::Rk4 stepper1;
+    pooya::FastSimulator sim1(model1, nullptr, &stepper1);
+    run_sampled_gains(model1, sim1);
+
+    SampledGains model4;
+    pooya::Rk4 stepper4;
+    pooya::FastSimulator sim4(model4, nullptr, &stepper4, 4);
+    sim4.set_min_chunk_size(1);
+    run_sampled_gains(model4, sim4);
+
+    // verify the results
+    for (int k = 0; k < SampledGains::num_gains; k++)
+    {
+        EXPECT_DOUBLE_EQ(model._w[k], model1._w[k]);
+        EXPECT_DOUBLE_EQ(model._w[k], model4._w[k]);
+        EXPECT_DOUBLE_EQ(model._u[k], model1._u[k]);
+        EXPECT_DOUBLE_EQ(model._u[k], model4._u[k]);
+    }
+}
@@ -19,8 +19,11 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <math.h>
+#include <memory>
 
 #include <gtest/gtest.h>
 
@@ -60,6 +63,39 @@ TEST_F(TestGain, ScalarGain)
     EXPECT_DOUBLE_EQ(gain_value * x, s_y);
 }
 
+TEST_F(TestGain, TwoSimulators)
+{
+    // test parameters
+    const double x = 3.7;
+    constexpr double gain_value{2.0};
+
+    // model setup
+    pooya::Gain gain(gain_value, nullptr, "gain");
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_y("y");
+    gain.connect({s_x}, {s_y});
+
+    // the second simulator takes the signals over from the first one, whose destruction leaves them bound
+    auto inputs = [&](pooya::Block&, double /*t*/) -> void { s_x = x; };
+    auto sim1   = std::make_unique<pooya::Simulator>(gain, inputs);
+    sim1->init(0.0);
+    pooya::Simulator sim2(gain, inputs);
+    sim2.init(0.0);
+    const double* storage = s_y->storage();
+    sim1.reset();
+    EXPECT_EQ(storage, s_y->storage());
+
+    // the arena of the values, the only two of which are x and y, starts on a cache line boundary
+    const double* arena = std::min(s_x->storage(), s_y->storage());
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(arena) % 64);
+
+    // do one step
+    sim2.run(0.1);
+
+    // verify the results
+    EXPECT_DOUBLE_EQ(gain_value * x, s_y);
+}
+
 #ifdef POOYA_INT_SIGNAL
 TEST_F(TestGain, IntGain)
 {
@@ -110,4 +146,30 @@ TEST_F(TestGain, ArrayGain)
         EXPECT_NEAR(gain_value * s_x[k], s_y[k], 1e-10);
     }
 }
+
+TEST_F(TestGain, ElementwiseArrayGain)
+{
+    // test parameters
+    constexpr std::size_t N = 4;
+    const pooya::ArrayN<N> x{3.7, -2.5, 10.45, 0.0};
+    const pooya::ArrayN<N> gain_value{-5.89, 0.0, 1.5, 2.0};
+
+    // model setup
+    pooya::GainAA gain(gain_value);
+    pooya::ArraySignal s_x(N);
+    pooya::ArraySignal s_y(N);
+    gain.connect({s_x}, {s_y});
+
+    // simulator setup
+    pooya::Simulator sim(gain, [&](pooya::Block&, double /*t*/) -> void { s_x = x; });
+
+    // do one step
+    sim.init(0.0);
+
+    // verify the results
+    for (std::size_t k = 0; k < N; k++)
+    {
+        EXPECT_NEAR(gain_value[k] * s_x[k], s_y[k], 1e-10);
+    }
+}
 #endif // POOYA_ARRAY_SIGNAL
@@ -0,0 +1,548 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/helper/defs.hpp"
+#include "src/signal/array_signal.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/columnar_file.hpp"
+#include "src/solver/history.hpp"
+#include "src/solver/history_sink.hpp"
+
+class TestHistory : public testing::Test
+{
+public:
+    TestHistory()
+    {
+        //
+    }
+};
+
+TEST_F(TestHistory, Columns)
+{
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_y("y");
+    pooya::ScalarSignal s_z("z");
+
+    pooya::History history(4);
+    EXPECT_TRUE(history.track(s_x));
+    EXPECT_TRUE(history.track(s_y));
+    EXPECT_FALSE(history.track(s_y));
+    EXPECT_TRUE(history.track(s_z));
+    history.untrack(s_y);
+
+    for (uint k = 0; k < 10; k++)
+    {
+        s_x->clear();
+        s_z->clear();
+        s_x = 2.0 * k;
+        if (k % 2 == 0) s_z = 3.0 * k; // unassigned values are recorded as 0
+        history.update(k, 0.1 * k);
+    }
+    history.shrink_to_fit();
+
+    // verify the results
+    EXPECT_EQ(10, history.nrows());
+    EXPECT_EQ(2, history.values().cols());
+    for (uint k = 0; k < 10; k++)
+    {
+        EXPECT_DOUBLE_EQ(0.1 * k, history.time()[k]);
+        EXPECT_DOUBLE_EQ(2.0 * k, history[s_x](k, 0));
+        EXPECT_DOUBLE_EQ(k % 2 == 0 ? 3.0 * k : 0.0, history[s_z](k, 0));
+    }
+}
+
+TEST_F(TestHistory, Chunks)
+{
+    pooya::ScalarSignal s_x("x");
+
+    pooya::History history(3);
+    history.track(s_x);
+
+    auto record = [&](uint k)
+    {
+        s_x->clear();
+        s_x = 2.0 * k;
+        history.update(k, k);
+    };
+
+    for (uint k = 0; k < 5; k++) record(k);
+    EXPECT_EQ(5, history.time().size());
+
+    // continue after the last chunk is trimmed
+    history.shrink_to_fit();
+    for (uint k = 5; k < 11; k++) record(k);
+
+    // verify the results
+    EXPECT_EQ(11, history.nrows());
+    EXPECT_EQ(11, history.values().rows());
+    for (uint k = 0; k < 11; k++)
+    {
+        EXPECT_DOUBLE_EQ(k, history.time()[k]);
+        EXPECT_DOUBLE_EQ(2.0 * k, history[s_x](k, 0));
+    }
+}
+
+// keeps the rows it receives
+class CollectingSink : public pooya::HistorySink
+{
+public:
+    std::vector<std::string> _names;
+    std::vector<std::vector<double>> _rows;
+    std::size_t _num_batches{0};
+    bool _closed{false};
+
+    void open(const std::vector<std::string>& names) override { _names = names; }
+    void write(const Eigen::Ref<const Eigen::MatrixXd>& rows) override
+    {
+        _num_batches++;
+        for (Eigen::Index k = 0; k < rows.rows(); k++)
+        {
+            _rows.emplace_back();
+            for (Eigen::Index j = 0; j < rows.cols(); j++) _rows.back().push_back(rows(k, j));
+        }
+    }
+    void close() override { _closed = true; }
+};
+
+TEST_F(TestHistory, Stream)
+{
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_y("y");
+
+    CollectingSink sink;
+    pooya::History history(4);
+    history.track(s_x);
+    history.track(s_y);
+    history.stream_to(sink);
+
+    for (uint k = 0; k < 10; k++)
+    {
+        s_x->clear();
+        s_y->clear();
+        s_x = 2.0 * k;
+        s_y = -1.0 * k;
+        history.update(k, 0.1 * k);
+    }
+
+    // the rows are streamed rather than kept
+    EXPECT_THROW(history.time(), std::runtime_error);
+    history.close_sink();
+
+    // verify the results
+    EXPECT_TRUE(sink._closed);
+    EXPECT_EQ(std::vector<std::string>({"time", "x", "y"}), sink._names);
+    EXPECT_EQ(3, sink._num_batches);
+    ASSERT_EQ(10, sink._rows.size());
+    for (uint k = 0; k < 10; k++)
+    {
+        EXPECT_EQ(std::vector<double>({0.1 * k, 2.0 * k, -1.0 * k}), sink._rows[k]);
+    }
+
+    // the history is empty after the sink is closed and keeps the rows again
+    EXPECT_EQ(0, history.nrows());
+    s_x->clear();
+    s_y->clear();
+    s_x = 1.0;
+    s_y = 2.0;
+    history.update(0, 0.5);
+    ASSERT_EQ(1, history.time().size());
+    EXPECT_EQ(0.5, history.time()[0]);
+    EXPECT_EQ(2.0, history[s_y](0, 0));
+}
+
+TEST_F(TestHistory, StreamSkippedChunk)
+{
+    pooya::ScalarSignal s_x("x");
+
+    CollectingSink sink;
+    pooya::History history(4);
+    history.track(s_x);
+    history.stream_to(sink);
+
+    s_x = 1.0;
+    history.update(0, 0.0);
+
+    // the rows of the chunk in between are never updated
+    s_x->clear();
+    s_x = 2.0;
+    EXPECT_THROW(history.update(9, 0.9), std::runtime_error);
+    history.update(4, 0.4);
+    history.close_sink();
+
+    ASSERT_EQ(5, sink._rows.size());
+    EXPECT_EQ(std::vector<double>({0.4, 2.0}), sink._rows[4]);
+}
+
+TEST_F(TestHistory, NullSink)
+{
+    pooya::ScalarSignal s_x("x");
+
+    pooya::NullHistorySink sink;
+    pooya::History history(4);
+    history.track(s_x);
+    history.stream_to(sink);
+    for (uint k = 0; k < 10; k++)
+    {
+        s_x->clear();
+        s_x = 2.0 * k;
+        history.update(k, 0.1 * k);
+    }
+    history.close_sink();
+
+    // the rows are only counted
+    EXPECT_EQ(10, sink.num_rows());
+}
+
+// reads a whole file
+std::string read_file(const std::string& filename)
+{
+    std::ifstream ifs(filename);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+TEST_F(TestHistory, Csv)
+{
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_y("y");
+
+    pooya::History history(512);
+    history.track(s_y);
+    history.track(s_x);
+    for (uint k = 0; k < 3000; k++)
+    {
+        s_x->clear();
+        s_y->clear();
+        s_x = k / 3.0;
+        s_y = -0.1 * k;
+        history.update(k, 0.001 * k);
+    }
+
+    const std::string filename1 = testing::TempDir() + "test_history_1.csv";
+    const std::string filename4 = testing::TempDir() + "test_history_4.csv";
+    history.export_csv(filename1);
+    history.export_csv(filename4, 4);
+    const auto csv  = read_file(filename1);
+    const auto csv4 = read_file(filename4);
+    std::remove(filename1.c_str());
+    std::remove(filename4.c_str());
+
+    // the columns are in the order of tracking and the values read back exactly, regardless of the threads
+    EXPECT_EQ(csv, csv4);
+    std::stringstream ss(csv);
+    std::string line;
+    std::getline(ss, line);
+    EXPECT_EQ("time,y,x", line);
+    uint k = 0;
+    for (; std::getline(ss, line); k++)
+    {
+        double t, y, x;
+        char c1, c2;
+        std::stringstream(line) >> t >> c1 >> y >> c2 >> x;
+        EXPECT_EQ(0.001 * k, t);
+        EXPECT_EQ(-0.1 * k, y);
+        EXPECT_EQ(k / 3.0, x);
+    }
+    EXPECT_EQ(3000, k);
+}
+
+// a CSV sink that records the most blocks it formatted at a time
+class BlockCountingSink : public pooya::CsvHistorySink
+{
+public:
+    using pooya::CsvHistorySink::CsvHistorySink;
+
+    std::size_t _max_blocks{0};
+
+    void write(const Eigen::Ref<const Eigen::MatrixXd>& rows) override
+    {
+        pooya::CsvHistorySink::write(rows);
+        _max_blocks = std::max(_max_blocks, _blocks.size());
+    }
+};
+
+TEST_F(TestHistory, CsvSmallBatches)
+{
+    pooya::ScalarSignal s_x("x");
+
+    // batches of fewer rows than a block of CSV
+    pooya::History history(500);
+    history.track(s_x);
+
+    const std::string filename = testing::TempDir() + "test_history_small_batches.csv";
+    BlockCountingSink sink(filename, 4);
+    history.stream_to(sink);
+    for (uint k = 0; k < 2000; k++)
+    {
+        s_x->clear();
+        s_x = k / 7.0;
+        history.update(k, 0.001 * k);
+    }
+    history.close_sink();
+    const auto csv = read_file(filename);
+    std::remove(filename.c_str());
+
+    // each batch is still split among the threads
+    EXPECT_GT(sink._max_blocks, 1u);
+    std::stringstream ss(csv);
+    std::string line;
+    std::getline(ss, line);
+    EXPECT_EQ("time,x", line);
+    uint k = 0;
+    for (; std::getline(ss, line); k++)
+    {
+        double t, x;
+        char c;
+        std::stringstream(line) >> t >> c >> x;
+        EXPECT_EQ(0.001 * k, t);
+        EXPECT_EQ(k / 7.0, x);
+    }
+    EXPECT_EQ(2000, k);
+}
+
+// reads a value of the native byte order from the stream
+template<typename T>
+T read_value(std::istream& is)
+{
+    T value{};
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+TEST_F(TestHistory, BinarySink)
+{
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_y("y");
+
+    pooya::History history(4);
+    history.track(s_x);
+    history.track(s_y);
+
+    const std::string filename = testing::TempDir() + "test_history_binary_sink.bin";
+    pooya::BinaryHistorySink sink(filename);
+    history.stream_to(sink);
+    for (uint k = 0; k < 10; k++)
+    {
+        s_x->clear();
+        s_y->clear();
+        s_x = k / 3.0;
+        s_y = -0.1 * k;
+        history.update(k, 0.001 * k);
+    }
+    history.close_sink();
+
+    // the names of the columns, each preceded by its length
+    std::ifstream ifs(filename, std::ios::binary);
+    ASSERT_EQ(3, read_value<std::uint64_t>(ifs));
+    std::vector<std::string> names;
+    for (int j = 0; j < 3; j++)
+    {
+        names.emplace_back(read_value<std::uint64_t>(ifs), '\0');
+        ifs.read(names.back().data(), static_cast<std::streamsize>(names.back().size()));
+    }
+    EXPECT_EQ(std::vector<std::string>({"time", "x", "y"}), names);
+
+    // the batches of nrows_grow rows and the remaining ones, column by column
+    uint k = 0;
+    for (std::uint64_t nrows : {4, 4, 2})
+    {
+        ASSERT_EQ(nrows, read_value<std::uint64_t>(ifs));
+        Eigen::MatrixXd rows(nrows, 3);
+        ifs.read(reinterpret_cast<char*>(rows.data()), static_cast<std::streamsize>(rows.size() * sizeof(double)));
+        for (Eigen::Index r = 0; r < rows.rows(); r++, k++)
+        {
+            EXPECT_EQ(0.001 * k, rows(r, 0));
+            EXPECT_EQ(k / 3.0, rows(r, 1));
+            EXPECT_EQ(-0.1 * k, rows(r, 2));
+        }
+    }
+    EXPECT_EQ(10, k);
+    ifs.peek();
+    EXPECT_TRUE(ifs.eof());
+    ifs.close();
+    std::remove(filename.c_str());
+}
+
+#ifdef POOYA_ARRAY_SIGNAL
+TEST_F(TestHistory, ArrayColumns)
+{
+    constexpr std::size_t N = 3;
+    pooya::ScalarSignal s_x("x");
+    pooya::ArraySignal s_a(N, "a");
+
+    pooya::History history;
+    history.track(s_a);
+    history.track(s_x);
+
+    for (uint k = 0; k < 5; k++)
+    {
+        s_x->clear();
+        s_a->clear();
+        s_x = -1.0 * k;
+        s_a = pooya::ArrayN<N>{1.0 * k, 2.0 * k, 3.0 * k};
+        history.update(k, k);
+    }
+
+    // verify the results
+    EXPECT_EQ(N + 1, history.values().cols());
+    EXPECT_EQ(N, history[s_a].cols());
+    for (uint k = 0; k < 5; k++)
+    {
+        for (std::size_t j = 0; j < N; j++)
+        {
+            EXPECT_DOUBLE_EQ((j + 1.0) * k, history[s_a](k, j));
+        }
+        EXPECT_DOUBLE_EQ(-1.0 * k, history[s_x](k, 0));
+    }
+}
+
+TEST_F(TestHistory, Columnar)
+{
+    constexpr std::size_t N = 2;
+    pooya::ScalarSignal s_x("x");
+    pooya::ArraySignal s_a(N, "a");
+
+    pooya::History history(4);
+    history.track(s_x);
+    history.track(s_a);
+    for (uint k = 0; k < 7; k++)
+    {
+        s_x->clear();
+        s_a->clear();
+        s_x = 2.0 * k;
+        s_a = pooya::ArrayN<N>{-1.0 * k, 0.5 * k};
+        history.update(k, 0.1 * k);
+    }
+
+    const std::string filename = testing::TempDir() + "test_history_columnar.bin";
+    history.export_columnar(filename);
+
+    {
+        pooya::ColumnarFile file(filename);
+
+        // verify the results
+        EXPECT_EQ(7, file.nrows());
+        ASSERT_TRUE(file.has_time());
+        ASSERT_EQ(2, file.signals().size());
+        EXPECT_EQ("x", file.signals()[0]._name);
+        EXPECT_EQ(pooya::ColumnarFile::Type::Scalar, file.signals()[0]._type);
+        EXPECT_EQ(pooya::ColumnarFile::Type::Array, file.signals()[1]._type);
+        EXPECT_EQ(N, file.signals()[1]._width);
+        EXPECT_TRUE((file.time() == history.time()).all());
+        EXPECT_TRUE((file["x"].array() == history[s_x].array()).all());
+        EXPECT_TRUE((file["a"].array() == history[s_a].array()).all());
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(file["a"].data()) % pooya::ColumnarFile::alignment);
+        EXPECT_THROW(file["y"], std::runtime_error);
+    }
+    std::remove(filename.c_str());
+}
+#endif // POOYA_ARRAY_SIGNAL
+
+TEST_F(TestHistory, ColumnarErrors)
+{
+    pooya::ScalarSignal s_x("x");
+
+    pooya::History history;
+    history.track(s_x);
+    for (uint k = 0; k < 10; k++)
+    {
+        s_x->clear();
+        s_x = 2.0 * k;
+        history.update(k, 0.1 * k);
+    }
+
+    const std::string filename  = testing::TempDir() + "test_history_columnar_errors.bin";
+    const std::string truncated = testing::TempDir() + "test_history_columnar_truncated.bin";
+    history.export_columnar(filename);
+    const auto content = read_file(filename);
+
+    // a file that is not a columnar one
+    std::ofstream(filename) << "time,x\n0,0\n";
+    EXPECT_THROW(pooya::ColumnarFile{filename}, std::runtime_error);
+
+    // a file that ends within the header and one that ends within the columns
+    std::ofstream(truncated, std::ios::binary) << content.substr(0, 20);
+    EXPECT_THROW(pooya::ColumnarFile{truncated}, std::runtime_error);
+    std::ofstream(truncated, std::ios::binary) << content.substr(0, content.size() / 2);
+    EXPECT_THROW(pooya::ColumnarFile{truncated}, std::runtime_error);
+
+    std::remove(filename.c_str());
+    std::remove(truncated.c_str());
+}
+
+TEST_F(TestHistory, ColumnarNames)
+{
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_x2("x");
+    pooya::ScalarSignal s_u;
+    pooya::ScalarSignal s_v;
+
+    pooya::History history;
+    history.track(s_u);
+    history.track(s_x);
+    history.track(s_v);
+    for (uint k = 0; k < 10; k++)
+    {
+        s_x->clear();
+        s_u->clear();
+        s_v->clear();
+        s_x = 2.0 * k;
+        s_u = -1.0 * k;
+        s_v = 0.5 * k;
+        history.update(k, 0.1 * k);
+    }
+
+    const std::string filename = testing::TempDir() + "test_history_columnar_names.bin";
+    history.export_columnar(filename);
+
+    {
+        pooya::ColumnarFile file(filename);
+
+        // the unnamed signals are only looked up by their index
+        ASSERT_EQ(3, file.signals().size());
+        EXPECT_TRUE((file.signal(0).array() == history[s_u].array()).all());
+        EXPECT_TRUE((file.signal(1).array() == file["x"].array()).all());
+        EXPECT_TRUE((file.signal(2).array() == history[s_v].array()).all());
+        EXPECT_THROW(file[""], std::runtime_error);
+        EXPECT_THROW(file.signal(3), std::runtime_error);
+    }
+    std::remove(filename.c_str());
+
+    // a name that is repeated would be ambiguous
+    pooya::History history2;
+    history2.track(s_x);
+    history2.track(s_x2);
+    s_x->clear();
+    s_x2->clear();
+    s_x  = 1.0;
+    s_x2 = 2.0;
+    history2.update(0, 0.0);
+    EXPECT_THROW(history2.export_columnar(filename), std::runtime_error);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,238 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/add.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/bdf.hpp"
+#include "src/solver/dopri54.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestJacobianPattern : public testing::Test
+{
+public:
+    TestJacobianPattern()
+    {
+        //
+    }
+};
+
+// x[i]' = k * (x[i - 1] - 2 * x[i] + x[i + 1]), a tridiagonal Jacobian
+class Chain : public pooya::Submodel
+{
+protected:
+    std::vector<std::unique_ptr<pooya::Integrator>> _integs;
+    std::vector<std::unique_ptr<pooya::Gain>> _gains;
+    std::vector<std::unique_ptr<pooya::Add>> _adds;
+    std::vector<std::unique_ptr<pooya::Gain>> _scales;
+
+public:
+    std::vector<pooya::ScalarSignal> _x;
+    std::vector<pooya::ScalarSignal> _g;
+    std::vector<pooya::ScalarSignal> _sum;
+    std::vector<pooya::ScalarSignal> _xd;
+
+    Chain(std::size_t n, double k)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            _x.emplace_back("x" + std::to_string(i));
+            _g.emplace_back("g" + std::to_string(i));
+            _sum.emplace_back("sum" + std::to_string(i));
+            _xd.emplace_back("xd" + std::to_string(i));
+
+            _integs.emplace_back(std::make_unique<pooya::Integrator>(i == 0 ? 1.0 : 0.0, this));
+            _gains.emplace_back(std::make_unique<pooya::Gain>(-2.0, this));
+            _adds.emplace_back(std::make_unique<pooya::Add>(0.0, this));
+            _scales.emplace_back(std::make_unique<pooya::Gain>(k, this));
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            _integs[i]->connect({_xd[i]}, {_x[i]});
+            _gains[i]->connect({_x[i]}, {_g[i]});
+            if (i == 0)
+            {
+                _adds[i]->connect({_g[i], _x[i + 1]}, {_sum[i]});
+            }
+            else if (i + 1 == n)
+            {
+                _adds[i]->connect({_x[i - 1], _g[i]}, {_sum[i]});
+            }
+            else
+            {
+                _adds[i]->connect({_x[i - 1], _g[i], _x[i + 1]}, {_sum[i]});
+            }
+            _scales[i]->connect({_sum[i]}, {_xd[i]});
+        }
+    }
+};
+
+TEST_F(TestJacobianPattern, Tridiagonal)
+{
+    // test parameters
+    const std::size_t n = 8;
+    const double k      = 100.0;
+
+    // model setup
+    Chain model(n, k);
+
+    // simulator setup
+    int num_evaluations{0};
+    pooya::Simulator sim(model, [&](pooya::Block&, double /*t*/) -> void { num_evaluations++; });
+    sim.init(0.0);
+
+    const auto& pattern = sim.jacobian_pattern();
+    EXPECT_EQ(n, pattern.size());
+    EXPECT_EQ(3 * n - 2, static_cast<std::size_t>(pattern.pattern().nonZeros()));
+    EXPECT_EQ(3, pattern.num_colors());
+    for (std::size_t col = 0; col + 1 < n; col++)
+    {
+        EXPECT_NE(pattern.color(col), pattern.color(col + 1));
+    }
+
+    pooya::Array x(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] = std::sin(static_cast<double>(i));
+    }
+    const pooya::Array derivs = sim.derivatives(0.0, x);
+
+    num_evaluations = 0;
+    Eigen::MatrixXd J(sim.compute_jacobian(0.0, x, derivs));
+    EXPECT_EQ(3, num_evaluations);
+
+    for (std::size_t row = 0; row < n; row++)
+    {
+        for (std::size_t col = 0; col < n; col++)
+        {
+            const double expected = (row == col) ? -2 * k : ((row == col + 1) || (col == row + 1)) ? k : 0;
+            EXPECT_NEAR(expected, J(row, col), 1e-5 * k);
+        }
+    }
+}
+
+TEST_F(TestJacobianPattern, IndependentStates)
+{
+    // model setup
+    pooya::Submodel model;
+
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_xd("xd");
+    pooya::ScalarSignal s_y("y");
+    pooya::ScalarSignal s_yd("yd");
+
+    pooya::Integrator integ_x(1.0, &model);
+    pooya::Integrator integ_y(1.0, &model);
+    pooya::Gain gain_x(-1.0, &model);
+    pooya::Gain gain_y(-2.0, &model);
+
+    integ_x.connect({s_xd}, {s_x});
+    integ_y.connect({s_yd}, {s_y});
+    gain_x.connect({s_x}, {s_xd});
+    gain_y.connect({s_y}, {s_yd});
+
+    // simulator setup
+    pooya::Simulator sim(model);
+    sim.init(0.0);
+
+    // both state variables are perturbed at once
+    EXPECT_EQ(1, sim.jacobian_pattern().num_colors());
+
+    pooya::Array x(2);
+    x << 1, 2;
+    Eigen::MatrixXd J(sim.compute_jacobian(0.0, x));
+    EXPECT_NEAR(-1, J(0, 0), 1e-6);
+    EXPECT_NEAR(-2, J(1, 1), 1e-6);
+    EXPECT_EQ(0, J(0, 1));
+    EXPECT_EQ(0, J(1, 0));
+}
+
+TEST_F(TestJacobianPattern, ImplicitStepper)
+{
+    // test parameters
+    const std::size_t n = 8;
+    const double k      = 100.0;
+
+    // the reference solution
+    Chain ref_model(n, k);
+    pooya::DoPri54 dopri54(1e-10, 1e-10);
+    pooya::Simulator ref_sim(ref_model, nullptr, &dopri54);
+    ref_sim.init(0.0);
+    ref_sim.run(0.1, 1e-8);
+
+    // the Jacobian is evaluated with the pattern of the model
+    Chain model(n, k);
+    pooya::Bdf bdf(1e-8, 1e-6);
+    pooya::Simulator sim(model, nullptr, &bdf);
+    sim.init(0.0);
+    sim.run(0.1, 1e-8);
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        EXPECT_NEAR(ref_model._x[i], model._x[i], 1e-4);
+    }
+}
+
+TEST_F(TestJacobianPattern, InputCallback)
+{
+    // x1' = x2, set by the input callback, and x2' = -x1
+    pooya::Submodel model;
+    pooya::ScalarSignal s_x1("x1");
+    pooya::ScalarSignal s_x2("x2");
+    pooya::ScalarSignal s_xd1("xd1");
+    pooya::ScalarSignal s_xd2("xd2");
+
+    pooya::Integrator integ1(1.0, &model);
+    pooya::Integrator integ2(0.0, &model);
+    pooya::Gain gain(-1.0, &model);
+
+    integ1.connect({s_xd1}, {s_x1});
+    integ2.connect({s_xd2}, {s_x2});
+    gain.connect({s_x1}, {s_xd2});
+
+    // simulator setup, the state variables are not assigned before the callback in init()
+    pooya::Simulator sim(model,
+                         [&](pooya::Block&, double /*t*/) -> void
+                         {
+                             if (s_x2->assigned())
+                             {
+                                 s_xd1 = double(s_x2);
+                             }
+                         });
+    sim.init(0.0);
+
+    // the derivative the callback assigns may depend on any state variable
+    const auto& pattern = sim.jacobian_pattern();
+    EXPECT_EQ(3, pattern.pattern().nonZeros());
+
+    pooya::Array x(2);
+    x << 0.3, -0.7;
+    const pooya::Array derivs = sim.derivatives(0.0, x);
+    Eigen::MatrixXd J(sim.compute_jacobian(0.0, x, derivs));
+    EXPECT_NEAR(0, J(0, 0), 1e-6);
+    EXPECT_NEAR(1, J(0, 1), 1e-6);
+    EXPECT_NEAR(-1, J(1, 0), 1e-6);
+    EXPECT_NEAR(0, J(1, 1), 1e-6);
+}
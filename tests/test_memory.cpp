@@ -21,8 +21,13 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <gtest/gtest.h>
 
 #include "src/block/extra/memory.hpp"
+#include "src/block/extra/source.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
 #include "src/signal/array_signal.hpp"
 #include "src/signal/scalar_signal.hpp"
+#include "src/solver/dopri54.hpp"
+#include "src/solver/rosenbrock23.hpp"
 #include "src/solver/simulator.hpp"
 
 class TestMemory : public testing::Test
@@ -56,6 +61,46 @@ TEST_F(TestMemory, ScalarMemory)
     EXPECT_EQ(x0, s_y);
 }
 
+// x' = m, where m is t at the end of the previous step
+double integrate_memory(pooya::StepperBase& stepper)
+{
+    // model setup
+    pooya::Submodel model;
+    pooya::Source source([](double t) -> double { return t; }, &model);
+    pooya::Memory memory(0.0, &model);
+    pooya::Integrator integ(0.0, &model);
+
+    pooya::ScalarSignal s_t;
+    pooya::ScalarSignal s_m;
+    pooya::ScalarSignal s_x;
+    source.connect({}, {s_t});
+    memory.connect({s_t}, {s_m});
+    integ.connect({s_m}, {s_x});
+
+    // simulator setup
+    pooya::Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    for (int k = 1; k <= 10; k++)
+    {
+        sim.run(0.1 * k);
+    }
+
+    return s_x;
+}
+
+TEST_F(TestMemory, FirstSameAsLast)
+{
+    // the memory changes its output after each step, so the last stage of a step is not reused by the next one
+    pooya::DoPri54 dopri54(1e-6, 1e-3, false);
+    pooya::DoPri54 dopri54_fsal;
+    EXPECT_EQ(integrate_memory(dopri54), integrate_memory(dopri54_fsal));
+    EXPECT_NEAR(0.45, integrate_memory(dopri54_fsal), 1e-10);
+
+    pooya::Rosenbrock23 rosenbrock23;
+    EXPECT_NEAR(0.45, integrate_memory(rosenbrock23), 1e-10);
+}
+
 #ifdef POOYA_ARRAY_SIGNAL
 TEST_F(TestMemory, ArrayMemory)
 {
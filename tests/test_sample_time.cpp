@@ -0,0 +1,310 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/const.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/extra/source.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/dopri54.hpp"
+#include "src/solver/fast_simulator.hpp"
+#include "src/solver/rk4.hpp"
+#include "src/solver/rkf45.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestSampleTime : public testing::Test
+{
+public:
+    TestSampleTime()
+    {
+        //
+    }
+};
+
+// a gain that counts its activations
+class CountingGain : public pooya::Gain
+{
+public:
+    CountingGain(double k, pooya::Submodel* parent) : pooya::Gain(k, parent) {}
+
+    int _num_activations{0};
+
+    void activation_function(double t) override
+    {
+        _num_activations++;
+        pooya::Gain::activation_function(t);
+    }
+};
+
+// a counting gain that is time-invariant and whose gain can be changed
+class ParameterGain : public CountingGain
+{
+public:
+    ParameterGain(double k, pooya::Submodel* parent) : CountingGain(k, parent) {}
+
+    bool time_invariant() const override { return true; }
+    void set_gain(double k) { _k = k; }
+};
+
+// x' = k * c, with the constant k * c evaluated once
+class ParameterRamp : public pooya::Submodel
+{
+protected:
+    pooya::Const _c{2.0, this};
+    pooya::Integrator _integ{0.0, this};
+
+public:
+    ParameterGain _scale{1.0, this};
+
+    pooya::ScalarSignal _c_sig{"c"};
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _x{"x"};
+
+    ParameterRamp()
+    {
+        _c.connect({}, {_c_sig});
+        _scale.connect({_c_sig}, {_xd});
+        _integ.connect({_xd}, {_x});
+    }
+};
+
+// a source that counts its activations
+class CountingSource : public pooya::Source
+{
+public:
+    CountingSource(SourceFunction src_func, pooya::Submodel* parent) : pooya::Source(src_func, parent) {}
+
+    int _num_activations{0};
+
+    void activation_function(double t) override
+    {
+        _num_activations++;
+        pooya::Source::activation_function(t);
+    }
+
+    bool time_only() const override { return true; }
+};
+
+// x' = 2 * t, with 2 * t only evaluated once per time
+class TimeRamp : public pooya::Submodel
+{
+protected:
+    pooya::Integrator _integ{0.0, this};
+
+public:
+    CountingSource _source{[](double t) -> double { return t; }, this};
+    ParameterGain _gain{2.0, this};
+
+    pooya::ScalarSignal _s{"s"};
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _x{"x"};
+
+    TimeRamp()
+    {
+        _source.connect({}, {_s});
+        _gain.connect({_s}, {_xd});
+        _integ.connect({_xd}, {_x});
+    }
+};
+
+// x' = 1, y = x sampled at 10 Hz, z' = y
+class SampledRamp : public pooya::Submodel
+{
+protected:
+    pooya::Const _one{1.0, this};
+    pooya::Integrator _integ_x{0.0, this};
+    pooya::Integrator _integ_z{0.0, this};
+
+public:
+    pooya::Submodel _controller{this};
+    CountingGain _sample{1.0, &_controller};
+    CountingGain _follower{1.0, this};
+
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _y{"y"};
+    pooya::ScalarSignal _w{"w"};
+    pooya::ScalarSignal _z{"z"};
+
+    SampledRamp()
+    {
+        _controller.set_sample_time(pooya::SampleTime::discrete(0.1));
+
+        _one.connect({}, {_xd});
+        _integ_x.connect({_xd}, {_x});
+        _sample.connect({_x}, {_y});
+        _follower.connect({_y}, {_w});
+        _integ_z.connect({_w}, {_z});
+    }
+};
+
+TEST_F(TestSampleTime, SampleHits)
+{
+    const auto sample_time = pooya::SampleTime::discrete(0.1, 0.05);
+    EXPECT_TRUE(sample_time.hit(0.05));
+    EXPECT_TRUE(sample_time.hit(0.1 + 0.2 + 0.05));
+    EXPECT_FALSE(sample_time.hit(0.1));
+    EXPECT_DOUBLE_EQ(0.15, sample_time.next_hit(0.05));
+    EXPECT_DOUBLE_EQ(0.15, sample_time.next_hit(0.1));
+    EXPECT_DOUBLE_EQ(0.05, sample_time.next_hit(0.0));
+}
+
+// num_init_activations is the number of activations in init()
+template<typename Simulator, typename Stepper>
+void run_sampled_ramp(int num_init_activations)
+{
+    // model setup
+    SampledRamp model;
+
+    // simulator setup
+    Stepper stepper;
+    Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    for (int k = 1; k <= 4; k++)
+    {
+        sim.run(0.25 * k);
+    }
+
+    // activated at 0.1, 0.2, ..., 1.0 only, the follower inherits the sample time
+    EXPECT_EQ(num_init_activations + 10, model._sample._num_activations);
+    EXPECT_EQ(num_init_activations + 10, model._follower._num_activations);
+    EXPECT_NEAR(1.0, model._y, 1e-10);
+
+    // z integrates the held samples
+    EXPECT_NEAR(0.45, model._z, 1e-10);
+}
+
+TEST_F(TestSampleTime, Simulator)
+{
+    run_sampled_ramp<pooya::Simulator, pooya::Rk4>(1);
+    run_sampled_ramp<pooya::Simulator, pooya::Rkf45>(1);
+
+    // the first stage is not reused from the step before a sample hit
+    run_sampled_ramp<pooya::Simulator, pooya::DoPri54>(1);
+}
+
+TEST_F(TestSampleTime, FastSimulator)
+{
+    // the processing order is found by activating the leaves once
+    run_sampled_ramp<pooya::FastSimulator, pooya::Rk4>(2);
+    run_sampled_ramp<pooya::FastSimulator, pooya::Rkf45>(2);
+    run_sampled_ramp<pooya::FastSimulator, pooya::DoPri54>(2);
+}
+
+// num_init_activations is the number of activations in init()
+template<typename Simulator, typename Stepper>
+void run_parameter_ramp(int num_init_activations)
+{
+    // model setup
+    ParameterRamp model;
+
+    // simulator setup
+    Stepper stepper;
+    Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    for (int k = 1; k <= 4; k++)
+    {
+        sim.run(0.25 * k);
+    }
+
+    // the gain is only fed by a constant, so it is not activated again
+    EXPECT_EQ(num_init_activations, model._scale._num_activations);
+    EXPECT_NEAR(2.0, model._x, 1e-10);
+
+    // the constant is evaluated again after its parameter changes
+    model._scale.set_gain(3.0);
+    sim.parameters_changed();
+    sim.run(2.0);
+
+    EXPECT_EQ(num_init_activations + 1, model._scale._num_activations);
+    EXPECT_NEAR(8.0, model._x, 1e-10);
+}
+
+TEST_F(TestSampleTime, Constant)
+{
+    EXPECT_TRUE(pooya::SampleTime::constant().is_constant());
+    EXPECT_FALSE(pooya::SampleTime::constant().is_discrete());
+    EXPECT_FALSE(pooya::SampleTime::constant().hit(0.0));
+
+    run_parameter_ramp<pooya::Simulator, pooya::Rk4>(1);
+    run_parameter_ramp<pooya::Simulator, pooya::Rkf45>(1);
+    run_parameter_ramp<pooya::FastSimulator, pooya::Rk4>(2);
+    run_parameter_ramp<pooya::FastSimulator, pooya::Rkf45>(2);
+}
+
+// a fast simulator that exposes the number of instructions of its tapes
+class TapeSimulator : public pooya::FastSimulator
+{
+public:
+    using pooya::FastSimulator::FastSimulator;
+
+    std::size_t tape_size() const { return _tape.size(); }
+    std::size_t constant_tape_size() const { return _constant_tape.size(); }
+};
+
+TEST_F(TestSampleTime, ConstantTape)
+{
+    // model setup
+    ParameterRamp model;
+
+    // simulator setup
+    pooya::Rk4 stepper;
+    TapeSimulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+
+    // only the integrator is evaluated in every step
+    EXPECT_EQ(1u, sim.tape_size());
+    EXPECT_EQ(2u, sim.constant_tape_size());
+
+    sim.run(1.0);
+    EXPECT_NEAR(2.0, model._x, 1e-10);
+}
+
+// num_init_activations is the number of activations in init()
+template<typename Simulator>
+void run_time_ramp(int num_init_activations)
+{
+    // model setup
+    TimeRamp model;
+
+    // simulator setup
+    pooya::Rk4 stepper;
+    Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    for (int k = 1; k <= 4; k++)
+    {
+        sim.run(0.25 * k);
+    }
+
+    // one step per run, the five evaluations of which are at three times, one of which is the end of the previous step
+    EXPECT_EQ(num_init_activations + 8, model._source._num_activations);
+    EXPECT_EQ(num_init_activations + 8, model._gain._num_activations);
+    EXPECT_NEAR(1.0, model._x, 1e-10);
+}
+
+TEST_F(TestSampleTime, TimeOnly)
+{
+    run_time_ramp<pooya::Simulator>(1);
+    run_time_ramp<pooya::FastSimulator>(2);
+}
@@ -74,3 +74,31 @@ TEST_F(TestScalarSignal, ScalarSignal)
     EXPECT_THROW(s_x->set_value(x), std::runtime_error);
 #endif // POOYA_DEBUG
 }
+
+TEST_F(TestScalarSignal, Epoch)
+{
+    // signal setup
+    pooya::ScalarSignal s_x;
+    uint64_t epoch = 1;
+
+    // the assignment is kept when the signal is bound to an epoch
+    s_x = 1.0;
+    s_x->bind_epoch(&epoch);
+    EXPECT_TRUE(s_x->assigned());
+
+    // incrementing the epoch clears the signal
+    epoch++;
+    EXPECT_FALSE(s_x->assigned());
+    EXPECT_NO_THROW(s_x = 2.0);
+    EXPECT_TRUE(s_x->assigned());
+
+    // and so does clear()
+    s_x->clear();
+    EXPECT_FALSE(s_x->assigned());
+
+    // back to the own epoch of the signal
+    s_x = 3.0;
+    s_x->bind_epoch(nullptr);
+    EXPECT_TRUE(s_x->assigned());
+    EXPECT_EQ(3.0, s_x);
+}
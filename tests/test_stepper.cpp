@@ -0,0 +1,417 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/gain.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/bdf.hpp"
+#include "src/solver/dopri54.hpp"
+#include "src/solver/euler.hpp"
+#include "src/solver/history.hpp"
+#include "src/solver/rk4.hpp"
+#include "src/solver/rkf45.hpp"
+#include "src/solver/rosenbrock23.hpp"
+#include "src/solver/simulator.hpp"
+#include "src/solver/step_size_controller.hpp"
+
+class TestStepper : public testing::Test
+{
+public:
+    TestStepper()
+    {
+        //
+    }
+};
+
+class MassSpring : public pooya::Submodel
+{
+protected:
+    pooya::Integrator _integ1{0.0, this};
+    pooya::Integrator _integ2{1.0, this};
+    pooya::Gain _gain{-1.0, this};
+
+public:
+    pooya::ScalarSignal _x{"x"};
+    pooya::ScalarSignal _xd{"xd"};
+    pooya::ScalarSignal _xdd{"xdd"};
+
+    MassSpring()
+    {
+        _integ1.connect({_xdd}, {_xd});
+        _integ2.connect({_xd}, {_x});
+        _gain.connect({_x}, {_xdd});
+    }
+};
+
+// runs the steps with the heap allocations of Eigen forbidden, the library and the tests are built with
+// EIGEN_RUNTIME_NO_MALLOC (see pooya_rules.bzl) and this test without EIGEN_NO_DEBUG (see BUILD), so an allocation in
+// the steps, which are instantiated here, fails an eigen_assert and aborts the process. The rest of the library is
+// built with EIGEN_NO_DEBUG and is not checked.
+template<typename Stepper>
+void step_without_allocation()
+{
+    // model setup
+    MassSpring model;
+
+    // simulator setup
+    Stepper stepper;
+    pooya::Simulator sim(model, nullptr, &stepper);
+    sim.init(0.0);
+
+    // the steppers allocate their workspaces in init
+    Eigen::internal::set_is_malloc_allowed(false);
+    for (int k = 1; k <= 100; k++)
+    {
+        sim.run(0.01 * k);
+    }
+    Eigen::internal::set_is_malloc_allowed(true);
+
+    std::exit(0);
+}
+
+TEST_F(TestStepper, NoAllocationPerStep)
+{
+#if defined(NDEBUG) || defined(EIGEN_NO_DEBUG) || !defined(EIGEN_RUNTIME_NO_MALLOC)
+    GTEST_SKIP() << "the heap allocations of Eigen are only checked by eigen_assert with EIGEN_RUNTIME_NO_MALLOC";
+#endif // defined(NDEBUG) || defined(EIGEN_NO_DEBUG) || !defined(EIGEN_RUNTIME_NO_MALLOC)
+
+    EXPECT_EXIT(step_without_allocation<pooya::Euler>(), testing::ExitedWithCode(0), "");
+    EXPECT_EXIT(step_without_allocation<pooya::Rk4>(), testing::ExitedWithCode(0), "");
+    EXPECT_EXIT(step_without_allocation<pooya::Rkf45>(), testing::ExitedWithCode(0), "");
+    EXPECT_EXIT(step_without_allocation<pooya::DoPri54>(), testing::ExitedWithCode(0), "");
+    EXPECT_EXIT(step_without_allocation<pooya::Rosenbrock23>(), testing::ExitedWithCode(0), "");
+    EXPECT_EXIT(step_without_allocation<pooya::Bdf>(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(TestStepper, DoPri54MassSpring)
+{
+    // model setup
+    MassSpring model;
+
+    // simulator setup
+    pooya::DoPri54 stepper(1e-8, 1e-8);
+    pooya::Simulator sim(model, nullptr, &stepper);
+
+    for (int k = 0; k <= 10; k++)
+    {
+        sim.run(k);
+    }
+
+    // verify the results
+    EXPECT_NEAR(std::cos(10.0), model._x, 1e-6);
+    EXPECT_NEAR(-std::sin(10.0), model._xd, 1e-6);
+}
+
+TEST_F(TestStepper, DoPri54FirstSameAsLast)
+{
+    // test parameters
+    const double h = 0.1;
+
+    // y' = y
+    int num_calls{0};
+    pooya::Array dy(1);
+    auto f = [&](double /*t*/, const pooya::Array& y) -> const pooya::Array&
+    {
+        num_calls++;
+        dy = y;
+        return dy;
+    };
+
+    pooya::DoPri54 stepper;
+    stepper.init(1);
+
+    pooya::Array y0(1);
+    pooya::Array y1(1);
+    pooya::Array y(1);
+    double new_h;
+
+    y0[0] = 1;
+    stepper.step_impl(f, 0, y0, h, y1, new_h);
+    EXPECT_EQ(7, num_calls);
+
+    for (int k = 1; k < 10; k++)
+    {
+        y0 = y1;
+        stepper.step_impl(f, k * h, y0, (k + 1) * h, y1, new_h);
+        EXPECT_EQ(7 + 6 * k, num_calls);
+    }
+    EXPECT_NEAR(std::exp(1.0), y1[0], 1e-6);
+
+    // dense output within the last step
+    for (double t = 0.9; t <= 1.0; t += 0.025)
+    {
+        stepper.dense_output(t, y);
+        EXPECT_NEAR(std::exp(t), y[0], 1e-6);
+    }
+}
+
+TEST_F(TestStepper, StepSizeController)
+{
+    pooya::StepSizeController controller(5);
+
+    // per-state tolerances
+    pooya::Array abs_tol(2);
+    pooya::Array rel_tol(2);
+    abs_tol << 1e-3, 1e-6;
+    rel_tol << 0, 0;
+    controller.set_tolerances(abs_tol, rel_tol);
+    controller.init(2);
+
+    pooya::Array v(2);
+    pooya::Array err(2);
+    v << 1, 1;
+    err << 1e-3, 0;
+    EXPECT_DOUBLE_EQ(std::sqrt(0.5), controller.error_norm(err, v, v));
+    err << 0, 1e-6;
+    EXPECT_DOUBLE_EQ(std::sqrt(0.5), controller.error_norm(err, v, v));
+
+    // a rejected step is retried with a smaller step
+    double h = controller.next_step(1, 2);
+    EXPECT_FALSE(controller.accepted());
+    EXPECT_LT(h, 1);
+
+    // the step does not grow right after a rejection
+    EXPECT_DOUBLE_EQ(h, controller.next_step(h, 1e-3));
+    EXPECT_TRUE(controller.accepted());
+
+    // but it does afterwards
+    EXPECT_GT(controller.next_step(h, 1e-3), h);
+    EXPECT_TRUE(controller.accepted());
+}
+
+// records the step sizes the simulator tries
+class RecordingDoPri54 : public pooya::DoPri54
+{
+public:
+    using pooya::DoPri54::DoPri54;
+
+    std::vector<double> _h;
+
+    void step_model(pooya::SimulatorBase& sim, double t0, const pooya::Array& v0, double t1, pooya::Array& v1,
+                    double& new_h) override
+    {
+        _h.push_back(t1 - t0);
+        pooya::DoPri54::step_model(sim, t0, v0, t1, v1, new_h);
+    }
+};
+
+TEST_F(TestStepper, StepSizeAcrossRuns)
+{
+    // model setup
+    MassSpring model;
+
+    // simulator setup
+    RecordingDoPri54 stepper(1e-8, 1e-8);
+    pooya::Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    sim.run(1.0);
+
+    // the next call continues with the step size of the previous one instead of trying the whole interval
+    stepper._h.clear();
+    sim.run(2.0);
+    ASSERT_FALSE(stepper._h.empty());
+    EXPECT_LT(stepper._h.front(), 0.5);
+}
+
+TEST_F(TestStepper, DenseOutputHistory)
+{
+    // test parameters
+    const double t1 = 10;
+    const double dt = 0.01;
+
+    // the rows within the steps are interpolated
+    MassSpring model1;
+    RecordingDoPri54 stepper1(1e-8, 1e-8);
+    pooya::Simulator sim1(model1, nullptr, &stepper1);
+    pooya::History history1;
+    history1.track(model1._x);
+    history1.track(model1._xd);
+    sim1.run(history1, 0, t1, dt);
+
+    // every step lands on an output time
+    MassSpring model2;
+    RecordingDoPri54 stepper2(1e-8, 1e-8);
+    pooya::Simulator sim2(model2, nullptr, &stepper2);
+    pooya::History history2;
+    history2.track(model2._x);
+    history2.track(model2._xd);
+    sim2.run(0);
+    history2.update(0, 0);
+    for (uint k = 1; k < history1.nrows(); k++)
+    {
+        const double t = k * dt;
+        sim2.run(t);
+        history2.update(k, t);
+    }
+
+    // verify the results
+    ASSERT_EQ(1001, history1.nrows());
+    EXPECT_LT(5 * stepper1._h.size(), history1.nrows());
+    EXPECT_LE(history2.nrows() - 1, stepper2._h.size());
+    for (uint k = 0; k < history1.nrows(); k++)
+    {
+        const double t = history1.time()[k];
+        EXPECT_DOUBLE_EQ(history2.time()[k], t);
+        EXPECT_NEAR(std::cos(t), history1[model1._x](k, 0), 1e-6);
+        EXPECT_NEAR(-std::sin(t), history1[model1._xd](k, 0), 1e-6);
+        EXPECT_NEAR(std::cos(t), history2[model2._x](k, 0), 1e-6);
+        EXPECT_NEAR(-std::sin(t), history2[model2._xd](k, 0), 1e-6);
+    }
+}
+
+// integrates y' = f(t, y) from 0 to t_end the way the simulator does and returns the number of evaluations of f
+template<typename Stepper, typename Callback>
+int integrate(Stepper& stepper, Callback& f, int& num_calls, pooya::Array& y, double t_end)
+{
+    stepper.init(y.size());
+
+    pooya::Array y1(y.size());
+    double t  = 0;
+    double h  = t_end;
+    num_calls = 0;
+    while (t < t_end)
+    {
+        const double t1 = std::min(t + h, t_end);
+        double new_h;
+        stepper.step_impl(f, t, y, t1, y1, new_h);
+        if (stepper.accepted(t1 - t, new_h))
+        {
+            t = t1;
+            y = y1;
+        }
+        h = new_h;
+    }
+
+    return num_calls;
+}
+
+TEST_F(TestStepper, StiffScalar)
+{
+    // y' = -1000 * (y - cos(t)) - sin(t), y = cos(t)
+    int num_calls{0};
+    pooya::Array dy(1);
+    auto f = [&](double t, const pooya::Array& y) -> const pooya::Array&
+    {
+        num_calls++;
+        dy[0] = -1000 * (y[0] - std::cos(t)) - std::sin(t);
+        return dy;
+    };
+
+    pooya::Array y(1);
+
+    // the explicit stepper is limited by stability rather than accuracy
+    pooya::DoPri54 dopri54;
+    y[0]                = 1;
+    const int num_dopri = integrate(dopri54, f, num_calls, y, 10);
+    EXPECT_NEAR(std::cos(10.0), y[0], 1e-3);
+
+    pooya::Rosenbrock23 rosenbrock23;
+    y[0] = 1;
+    EXPECT_LT(5 * integrate(rosenbrock23, f, num_calls, y, 10), num_dopri);
+    EXPECT_NEAR(std::cos(10.0), y[0], 1e-3);
+
+    pooya::Bdf bdf;
+    y[0] = 1;
+    EXPECT_LT(5 * integrate(bdf, f, num_calls, y, 10), num_dopri);
+    EXPECT_NEAR(std::cos(10.0), y[0], 1e-3);
+}
+
+TEST_F(TestStepper, StiffSystem)
+{
+    // y' = A * y, the eigenvalues of A are -1 and -1000
+    int num_calls{0};
+    pooya::Array dy(2);
+    auto f = [&](double /*t*/, const pooya::Array& y) -> const pooya::Array&
+    {
+        num_calls++;
+        dy[0] = -500.5 * y[0] + 499.5 * y[1];
+        dy[1] = 499.5 * y[0] - 500.5 * y[1];
+        return dy;
+    };
+
+    pooya::Array y(2);
+
+    // y = exp(-t) * [1, 1] + exp(-1000 * t) * [1, -1]
+    pooya::Rosenbrock23 rosenbrock23;
+    y << 2, 0;
+    integrate(rosenbrock23, f, num_calls, y, 1);
+    EXPECT_NEAR(std::exp(-1.0), y[0], 1e-3);
+    EXPECT_NEAR(std::exp(-1.0), y[1], 1e-3);
+
+    pooya::Bdf bdf;
+    y << 2, 0;
+    integrate(bdf, f, num_calls, y, 1);
+    EXPECT_NEAR(std::exp(-1.0), y[0], 1e-3);
+    EXPECT_NEAR(std::exp(-1.0), y[1], 1e-3);
+    EXPECT_GT(bdf.order(), 1);
+}
+
+TEST_F(TestStepper, BdfNewtonFailure)
+{
+    // y + gamma * 1000 * sign(y) = y0 has no solution for small y0, so the Newton iteration cannot converge
+    pooya::Array dy(1);
+    auto f = [&](double /*t*/, const pooya::Array& y) -> const pooya::Array&
+    {
+        dy[0] = (y[0] > 0) ? -1000.0 : 1000.0;
+        return dy;
+    };
+
+    pooya::Bdf bdf;
+    bdf.init(1);
+
+    pooya::Array y0(1);
+    pooya::Array y1(1);
+    y0[0] = 1e-3;
+    double new_h;
+    bdf.step_impl(f, 0, y0, 1, y1, new_h);
+
+    // the unconverged iterate is not handed back
+    EXPECT_TRUE(bdf.failed());
+    EXPECT_FALSE(bdf.accepted(1, new_h));
+    EXPECT_EQ(y0[0], y1[0]);
+    EXPECT_LT(new_h, 1);
+}
+
+TEST_F(TestStepper, Rosenbrock23Nonlinear)
+{
+    // y' = -100 * y^2, y = 1 / (1 + 100 * t), the Jacobian changes with y from one step to the next
+    int num_calls{0};
+    pooya::Array dy(1);
+    auto f = [&](double /*t*/, const pooya::Array& y) -> const pooya::Array&
+    {
+        num_calls++;
+        dy[0] = -100 * y[0] * y[0];
+        return dy;
+    };
+
+    pooya::Array y(1);
+
+    // the error estimate is reliable with the Jacobian at the start of every step
+    pooya::Rosenbrock23 rosenbrock23(1e-8, 1e-6);
+    y[0] = 1;
+    integrate(rosenbrock23, f, num_calls, y, 1);
+    EXPECT_NEAR(1.0 / 101, y[0], 5e-7);
+}
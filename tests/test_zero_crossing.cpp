@@ -0,0 +1,240 @@
+/*
+Copyright 2025 Mojtaba (Moji) Fathi
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files (the “Software”), to deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/block/extra/const.hpp"
+#include "src/block/extra/gain.hpp"
+#include "src/block/extra/so_function.hpp"
+#include "src/block/extra/triggered_integrator.hpp"
+#include "src/block/integrator.hpp"
+#include "src/block/submodel.hpp"
+#include "src/signal/scalar_signal.hpp"
+#include "src/solver/bdf.hpp"
+#include "src/solver/dopri54.hpp"
+#include "src/solver/rkf45.hpp"
+#include "src/solver/rosenbrock23.hpp"
+#include "src/solver/simulator.hpp"
+
+class TestZeroCrossing : public testing::Test
+{
+public:
+    TestZeroCrossing()
+    {
+        //
+    }
+};
+
+// a unity gain that records the times of the events of its input crossing zero
+class ZeroDetector : public pooya::Gain
+{
+public:
+    explicit ZeroDetector(pooya::Submodel* parent) : pooya::Gain(1.0, parent) {}
+
+    std::vector<double> _times;
+
+    std::size_t num_zero_crossings() const override { return 1; }
+    void zero_crossings(double /*t*/, double* values) const override { values[0] = _s_in->get_value(); }
+
+    void post_step(double t) override
+    {
+        if (!_times.empty() || (t > 0))
+        {
+            _times.push_back(t);
+        }
+    }
+};
+
+template<typename Stepper>
+double reset_time()
+{
+    // model setup
+    pooya::Submodel model;
+
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_xd("xd");
+    pooya::BoolSignal s_trigger("trigger");
+
+    pooya::Const one(1.0, &model);
+    pooya::TriggeredIntegrator integ(0.0, &model);
+    pooya::SOFunctionT<bool> threshold(
+        [](double /*t*/, const pooya::Bus& ibus) -> bool { return pooya::ScalarSignal(ibus.at(0)) >= 0.55; }, &model);
+
+    one.connect({}, {s_xd});
+    integ.connect({{"in", s_xd}, {"trigger", s_trigger}}, {s_x});
+    threshold.connect({s_x}, {s_trigger});
+
+    // simulator setup
+    Stepper stepper;
+    pooya::Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    sim.run(1.0);
+
+    // x is reset once it reaches 0.55
+    return 1.0 - s_x;
+}
+
+TEST_F(TestZeroCrossing, TriggeredIntegrator)
+{
+    // a step ends where the trigger switches, so the reset is at 0.55 regardless of the step size
+    EXPECT_NEAR(0.55, reset_time<pooya::DoPri54>(), 1e-8);
+    EXPECT_NEAR(0.55, reset_time<pooya::Rosenbrock23>(), 1e-8);
+    EXPECT_NEAR(0.55, reset_time<pooya::Bdf>(), 1e-8);
+
+    // without an interpolant the stepper is called again within the step
+    EXPECT_NEAR(0.55, reset_time<pooya::Rkf45>(), 1e-8);
+}
+
+// the number of events found within tol of the zero crossings of x = cos(t), at pi / 2 and 3 * pi / 2
+template<typename Stepper>
+int num_cosine_events(double stepper_tol, double tol)
+{
+    // model setup
+    pooya::Submodel model;
+
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_xd("xd");
+    pooya::ScalarSignal s_xdd("xdd");
+    pooya::ScalarSignal s_y("y");
+
+    pooya::Integrator integ1(0.0, &model);
+    pooya::Integrator integ2(1.0, &model);
+    pooya::Gain gain(-1.0, &model);
+    ZeroDetector detector(&model);
+
+    integ1.connect({s_xdd}, {s_xd});
+    integ2.connect({s_xd}, {s_x});
+    gain.connect({s_x}, {s_xdd});
+    detector.connect({s_x}, {s_y});
+
+    // simulator setup
+    Stepper stepper(stepper_tol, stepper_tol);
+    pooya::Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    sim.run(5.0);
+
+    const double pi = std::acos(-1.0);
+    int num_events{0};
+    for (auto t : detector._times)
+    {
+        if ((std::abs(t - pi / 2) < tol) || (std::abs(t - 3 * pi / 2) < tol))
+        {
+            num_events++;
+        }
+    }
+    return num_events;
+}
+
+TEST_F(TestZeroCrossing, ContinuousFunction)
+{
+    // the steps end where x crosses zero
+    EXPECT_EQ(2, num_cosine_events<pooya::DoPri54>(1e-10, 1e-8));
+
+    // located with the polynomial of the last step, to the accuracy of the solution
+    EXPECT_EQ(2, num_cosine_events<pooya::Bdf>(1e-6, 1e-4));
+
+    // located with steps within the step, which leave the step size controller as it was
+    EXPECT_EQ(2, num_cosine_events<pooya::Rkf45>(1e-10, 1e-7));
+}
+
+// records the start of each step and whether the stepper could reuse the stages or the history of the step before
+template<typename Stepper>
+class ReuseRecorder : public Stepper
+{
+public:
+    using Stepper::Stepper;
+
+    std::vector<std::pair<double, bool>> _steps;
+
+    void step_model(pooya::SimulatorBase& sim, double t0, const pooya::Array& v0, double t1, pooya::Array& v1,
+                    double& new_h) override
+    {
+        if constexpr (std::is_same_v<Stepper, pooya::DoPri54>)
+        {
+            _steps.emplace_back(t0, this->_reusable);
+        }
+        else
+        {
+            _steps.emplace_back(t0, this->_pending);
+        }
+        Stepper::step_model(sim, t0, v0, t1, v1, new_h);
+    }
+};
+
+// the number of the steps right after the zero crossings of x = cos(t), at pi / 2 and 3 * pi / 2, that could reuse
+// the step before
+template<typename Stepper>
+int num_steps_reusing_across_events(double stepper_tol, double tol)
+{
+    // model setup
+    pooya::Submodel model;
+
+    pooya::ScalarSignal s_x("x");
+    pooya::ScalarSignal s_xd("xd");
+    pooya::ScalarSignal s_xdd("xdd");
+    pooya::ScalarSignal s_y("y");
+
+    pooya::Integrator integ1(0.0, &model);
+    pooya::Integrator integ2(1.0, &model);
+    pooya::Gain gain(-1.0, &model);
+    ZeroDetector detector(&model);
+
+    integ1.connect({s_xdd}, {s_xd});
+    integ2.connect({s_xd}, {s_x});
+    gain.connect({s_x}, {s_xdd});
+    detector.connect({s_x}, {s_y});
+
+    // simulator setup
+    ReuseRecorder<Stepper> stepper(stepper_tol, stepper_tol);
+    pooya::Simulator sim(model, nullptr, &stepper);
+
+    sim.init(0.0);
+    sim.run(5.0);
+
+    // a step that is retried may reuse its own first stage, only the first step after each event counts
+    const double pi = std::acos(-1.0);
+    int num_steps{0};
+    int num_reusing{0};
+    for (double t : {pi / 2, 3 * pi / 2})
+    {
+        for (const auto& [t0, reusable] : stepper._steps)
+        {
+            if (std::abs(t0 - t) < tol)
+            {
+                num_steps++;
+                num_reusing += reusable ? 1 : 0;
+                break;
+            }
+        }
+    }
+    EXPECT_EQ(2, num_steps);
+    return num_reusing;
+}
+
+TEST_F(TestZeroCrossing, StepAfterEvent)
+{
+    // the step after an event does not reuse the last stage or the history of the step that ends at the event
+    EXPECT_EQ(0, num_steps_reusing_across_events<pooya::DoPri54>(1e-10, 1e-8));
+    EXPECT_EQ(0, num_steps_reusing_across_events<pooya::Bdf>(1e-6, 1e-4));
+}